@@ -27,6 +27,7 @@
 #include "uca-camera.h"
 #include "uca-plugin-manager.h"
 #include "uca-ring-buffer.h"
+#include "uca-unpack.h"
 #include "egg-property-tree-view.h"
 #include "egg-histogram-view.h"
 
@@ -82,6 +83,8 @@ typedef struct {
     GtkToggleButton *log_button;
     UcaRingBuffer   *buffer;
     guchar          *shadow;
+    gpointer        packed;
+    UcaFrameFormat  packed_format;
     guchar          *pixels;
     cairo_t         *cr;
     State           state;
@@ -117,6 +120,7 @@ typedef struct {
 
 static UcaPluginManager *plugin_manager;
 static gsize mem_size = 2048;
+static gchar *backing_file = NULL;
 
 static void update_pixbuf (ThreadData *data, gpointer buffer);
 static void update_pixbuf_dimensions (ThreadData *data);
@@ -853,6 +857,18 @@ set_tool_button_state (ThreadData *data)
                               data->state == IDLE);
 }
 
+static void
+grab_frame (ThreadData *data, gpointer buffer, GError **error)
+{
+    if (data->packed == NULL) {
+        uca_camera_grab (data->camera, buffer, error);
+        return;
+    }
+
+    if (uca_camera_grab (data->camera, data->packed, error))
+        uca_unpack_frame (&data->packed_format, data->packed, buffer);
+}
+
 static gpointer
 preview_frames (void *args)
 {
@@ -863,11 +879,11 @@ preview_frames (void *args)
     data->n_recorded = 0;
     data->shadow = g_malloc (uca_ring_buffer_get_block_size (data->buffer));
 
-    uca_camera_grab (data->camera, data->shadow, &error);
+    grab_frame (data, data->shadow, &error);
 
     while (data->state == RUNNING) {
         up_and_down_scale (data, data->shadow);
-        uca_camera_grab (data->camera, data->shadow, &error);
+        grab_frame (data, data->shadow, &error);
 
         gdk_threads_enter ();
 
@@ -917,7 +933,7 @@ record_frames (gpointer args)
             break;
 
         buffer = uca_ring_buffer_get_write_pointer (data->buffer);
-        uca_camera_grab (data->camera, buffer, NULL);
+        grab_frame (data, buffer, NULL);
         uca_ring_buffer_write_advance (data->buffer);
 
         if (error == NULL) {
@@ -970,8 +986,7 @@ update_current_frame (ThreadData *data)
     n_max = uca_ring_buffer_get_num_blocks (data->buffer);
 
     if (n_max > 0 && data->n_recorded > 0) {
-        /* Shift index so that we always show the oldest frames first */
-        index = (index + data->n_recorded - n_max) % n_max;
+        /* The ring buffer drops the oldest frames, index 0 is the oldest kept */
         buffer = uca_ring_buffer_get_pointer (data->buffer, index);
     }
     else {
@@ -1125,7 +1140,7 @@ download_frames (ThreadData *data)
 
     while (error == NULL) {
         buffer = uca_ring_buffer_get_write_pointer (data->buffer);
-        uca_camera_grab (data->camera, buffer, &error);
+        grab_frame (data, buffer, &error);
         uca_ring_buffer_write_advance (data->buffer);
 
         gdk_threads_enter ();
@@ -1275,6 +1290,17 @@ on_colormap_changed (GtkComboBox *widget, ThreadData *data)
     update_pixbuf (data, uca_ring_buffer_peek_pointer (data->buffer));
 }
 
+static gint
+get_pixel_size (UcaCamera *camera)
+{
+    UcaFrameFormat format;
+
+    uca_camera_get_frame_format (camera, &format);
+
+    /* Packed pixels are displayed once they are unpacked to 16 bit */
+    return format.bytes_per_pixel > 0 ? format.bytes_per_pixel : 2;
+}
+
 static void
 update_ring_buffer_dimensions (ThreadData *data)
 {
@@ -1287,6 +1313,27 @@ update_ring_buffer_dimensions (ThreadData *data)
     if (data->buffer != NULL)
         g_object_unref (data->buffer);
 
+    g_free (data->packed);
+    data->packed = NULL;
+    uca_camera_get_frame_format (data->camera, &data->packed_format);
+
+    if (uca_pixel_format_is_packed (data->packed_format.pixel_format))
+        data->packed = g_malloc (data->packed_format.size);
+
+    if (backing_file != NULL) {
+        GError *error = NULL;
+
+        data->buffer = uca_ring_buffer_new_mapped (backing_file, image_size, num_frames, &error);
+
+        if (data->buffer != NULL) {
+            g_message ("Mapped `%s' for %d frames", backing_file, num_frames);
+            return;
+        }
+
+        g_warning ("%s, using memory instead", error->message);
+        g_error_free (error);
+    }
+
     data->buffer = uca_ring_buffer_new (image_size, num_frames);
     g_message ("Allocated memory for %d frames", num_frames);
 }
@@ -1313,7 +1360,7 @@ on_sensor_bitdepth_changed (GObject *object, GParamSpec *pspec, ThreadData *data
     guint bitdepth;
     gdouble max_value;
     g_object_get (object, "sensor-bitdepth", &bitdepth, NULL);
-    data->pixel_size = bitdepth > 8 ? 2 : 1;
+    data->pixel_size = get_pixel_size (UCA_CAMERA (object));
     max_value = pow (2, bitdepth);
     egg_histogram_view_set_max (EGG_HISTOGRAM_VIEW (data->histogram_view), max_value);
     update_ring_buffer_dimensions (data);
@@ -1409,7 +1456,8 @@ create_main_window (GtkBuilder *builder, const gchar* camera_name)
     td.download_adjustment = GTK_ADJUSTMENT (gtk_builder_get_object (builder, "download-adjustment"));
 
     /* Set initial data */
-    td.pixel_size = bits_per_sample > 8 ? 2 : 1;
+    td.camera = camera;
+    td.pixel_size = get_pixel_size (camera);
     td.width  = td.display_width = width;
     td.height = td.display_height = height;
     update_ring_buffer_dimensions (&td);
@@ -1425,7 +1473,6 @@ create_main_window (GtkBuilder *builder, const gchar* camera_name)
 
     td.image  = image;
     td.state  = IDLE;
-    td.camera = camera;
     td.zoom_factor = 1.0;
     td.colormap = 1;
     td.histogram_view = histogram_view;
@@ -1559,6 +1606,7 @@ main (int argc, char *argv[])
     static GOptionEntry entries[] =
     {
         { "mem-size", 'm', 0, G_OPTION_ARG_INT, &mem_size, "Memory in megabytes to allocate for frame storage", "M" },
+        { "backing-file", 'b', 0, G_OPTION_ARG_STRING, &backing_file, "Store frames in FILE, --mem-size then sets its size", "FILE" },
         { "camera", 'c', 0, G_OPTION_ARG_STRING, &camera_name, "Default camera (skips choice window)", "NAME" },
         { NULL }
     };
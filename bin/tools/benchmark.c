@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include "uca-camera.h"
 #include "uca-plugin-manager.h"
+#include "uca-trace.h"
 #include "common.h"
 
 
@@ -32,6 +33,7 @@ typedef struct {
     gboolean test_software;
     gboolean test_external;
     gboolean test_readout;
+    gchar *trace;
 
     gsize n_bytes;
 } Options;
@@ -117,6 +119,7 @@ grab_frames_sync (UcaCamera *camera, gpointer buffer, guint n_frames, UcaCameraT
 static guint
 grab_frames_readout (UcaCamera *camera, gpointer buffer, guint n_frames, UcaCameraTriggerSource trigger_source, GTimer *timer)
 {
+    UcaCameraReadoutRange *range;
     GError *error = NULL;
     guint recorded_frames = 0;
 
@@ -135,13 +138,25 @@ grab_frames_readout (UcaCamera *camera, gpointer buffer, guint n_frames, UcaCame
     g_timer_start (timer);
     
     /*This is required because its possible that the camera has recorded frames more
-    than what is required. Index starts at 1 for consistency (camRAM index start from 1)*/
-    for(int i = 1; i <= n_frames; i++) {
-        uca_camera_grab (camera, buffer, &error);
-        if(error != NULL){
-            g_warning("There was an error grabbing frame %d during readout from camRAM",i+1);
-            error = NULL;
+    than what is required. Index starts at 1 for consistency (camRAM index start from 1).
+    Frames are prefetched in the background while the previous one is copied.*/
+    range = uca_camera_readout_range (camera, 1, n_frames, NULL, NULL, NULL, &error);
+
+    if (range == NULL) {
+        g_warning ("Could not start readout from camRAM: %s", error->message);
+        g_clear_error (&error);
+    }
+    else {
+        for (guint i = 1; i <= n_frames; i++) {
+            if (!uca_camera_readout_range_grab (range, buffer, NULL, &error)) {
+                g_warning ("There was an error grabbing frame %d during readout from camRAM: %s",
+                           i, error->message);
+                g_clear_error (&error);
+                break;
+            }
         }
+
+        uca_camera_readout_range_free (range);
     }
 
     g_timer_stop (timer);
@@ -247,8 +262,6 @@ benchmark (UcaCamera *camera, Options *options)
     guint sensor_height;
     guint roi_width;
     guint roi_height;
-    guint bits;
-    gsize n_bytes_per_pixel;
     gdouble exposure_time;
     gpointer buffer;
 
@@ -256,7 +269,6 @@ benchmark (UcaCamera *camera, Options *options)
                   "name", &name,
                   "sensor-width", &sensor_width,
                   "sensor-height", &sensor_height,
-                  "sensor-bitdepth", &bits,
                   "roi-width", &roi_width,
                   "roi-height", &roi_height,
                   "exposure-time", &exposure_time,
@@ -268,8 +280,7 @@ benchmark (UcaCamera *camera, Options *options)
     g_free (name);
 
     /* Synchronous frame acquisition */
-    n_bytes_per_pixel = bits > 8 ? 2 : 1;
-    options->n_bytes = roi_width * roi_height * n_bytes_per_pixel;
+    options->n_bytes = uca_camera_get_frame_size (camera);
     buffer = g_malloc0 (options->n_bytes);
 
     g_object_set (G_OBJECT(camera), "transfer-asynchronously", FALSE, NULL);
@@ -316,6 +327,7 @@ main (int argc, char *argv[])
         .test_software = FALSE,
         .test_external = FALSE,
         .test_readout = FALSE,
+        .trace = NULL,
     };
 
     static GOptionEntry entries[] = {
@@ -325,6 +337,7 @@ main (int argc, char *argv[])
         { "software", 0, 0, G_OPTION_ARG_NONE, &options.test_software, "Test software trigger mode", NULL },
         { "external", 0, 0, G_OPTION_ARG_NONE, &options.test_external, "Test external trigger mode", NULL },
         { "readout", 0, 0, G_OPTION_ARG_NONE, &options.test_readout, "Test readout from camRAM instead of sync acquisition", NULL},
+        { "trace", 0, 0, G_OPTION_ARG_FILENAME, &options.trace, "Write a Chrome trace of the acquisition to FILE", "FILE" },
         { NULL }
     };
 
@@ -359,8 +372,20 @@ main (int argc, char *argv[])
         goto cleanup_manager;
     }
 
+    if (options.trace != NULL)
+        uca_trace_enable (TRUE);
+
     benchmark (camera, &options);
 
+    if (options.trace != NULL) {
+        uca_trace_enable (FALSE);
+
+        if (!uca_trace_dump (options.trace, &error)) {
+            g_print ("Writing trace: %s\n", error->message);
+            g_clear_error (&error);
+        }
+    }
+
     g_io_channel_shutdown (log_channel, TRUE, &error);
     g_assert_no_error (error);
 
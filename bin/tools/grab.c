@@ -34,31 +34,23 @@ typedef struct {
     gint n_frames;
     gdouble duration;
     gchar *filename;
+    gchar *backing_file;
+    gboolean unpack;
 #ifdef HAVE_LIBTIFF
     gboolean write_tiff;
 #endif
 } Options;
 
 
-static guint
-get_bytes_per_pixel (guint bits_per_pixel)
-{
-    return bits_per_pixel > 8 ? 2 : 1;
-}
-
 #ifdef HAVE_LIBTIFF
 static void
 write_tiff (UcaRingBuffer *buffer,
             Options *opts,
-            guint width,
-            guint height,
-            guint bits_per_pixel)
+            UcaFrameFormat *format)
 {
     TIFF *tif;
     guint32 rows_per_strip;
     guint n_frames;
-    guint bits_per_sample;
-    gsize bytes_per_pixel;
 
     if (opts->filename)
         tif = TIFFOpen (opts->filename, "w");
@@ -67,8 +59,6 @@ write_tiff (UcaRingBuffer *buffer,
 
     n_frames = uca_ring_buffer_get_num_blocks (buffer);
     rows_per_strip = TIFFDefaultStripSize (tif, (guint32) - 1);
-    bytes_per_pixel = get_bytes_per_pixel (bits_per_pixel);
-    bits_per_sample = bits_per_pixel > 8 ? 16 : 8;
 
     /* Write multi page TIFF file */
     TIFFSetField (tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
@@ -79,16 +69,16 @@ write_tiff (UcaRingBuffer *buffer,
 
         data = uca_ring_buffer_get_read_pointer (buffer);
 
-        TIFFSetField (tif, TIFFTAG_IMAGEWIDTH, width);
-        TIFFSetField (tif, TIFFTAG_IMAGELENGTH, height);
-        TIFFSetField (tif, TIFFTAG_BITSPERSAMPLE, bits_per_sample);
+        TIFFSetField (tif, TIFFTAG_IMAGEWIDTH, format->width);
+        TIFFSetField (tif, TIFFTAG_IMAGELENGTH, format->height);
+        TIFFSetField (tif, TIFFTAG_BITSPERSAMPLE, format->bits_per_pixel);
         TIFFSetField (tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT);
         TIFFSetField (tif, TIFFTAG_SAMPLESPERPIXEL, 1);
         TIFFSetField (tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
         TIFFSetField (tif, TIFFTAG_ROWSPERSTRIP, rows_per_strip);
         TIFFSetField (tif, TIFFTAG_PAGENUMBER, i, n_frames);
 
-        for (guint y = 0; y < height; y++, offset += width * bytes_per_pixel)
+        for (guint y = 0; y < format->height; y++, offset += format->stride)
             TIFFWriteScanline (tif, data + offset, y, 0);
 
         TIFFWriteDirectory (tif);
@@ -130,11 +120,7 @@ write_raw (UcaRingBuffer *buffer,
 static GError *
 record_frames (UcaCamera *camera, Options *opts)
 {
-    guint roi_width;
-    guint roi_height;
-    guint bits;
-    guint pixel_size;
-    gsize size;
+    UcaFrameFormat format;
     gint n_frames;
     guint n_allocated;
     GTimer *timer;
@@ -142,21 +128,26 @@ record_frames (UcaCamera *camera, Options *opts)
     GError *error = NULL;
     gdouble last_printed;
 
-    g_object_get (G_OBJECT (camera),
-                  "roi-width", &roi_width,
-                  "roi-height", &roi_height,
-                  "sensor-bitdepth", &bits,
-                  NULL);
-
     g_object_set (G_OBJECT (camera), "trigger-source", UCA_CAMERA_TRIGGER_SOURCE_AUTO, NULL);
 
-    pixel_size = get_bytes_per_pixel (bits);
-    size = roi_width * roi_height * pixel_size;
+    if (opts->unpack)
+        g_object_set (G_OBJECT (camera), "buffered", TRUE, "buffer-unpack", TRUE, NULL);
+
+    uca_camera_get_frame_format (camera, &format);
     n_allocated = opts->n_frames > 0 ? opts->n_frames : 256;
-    buffer = uca_ring_buffer_new (size, n_allocated);
+
+    if (opts->backing_file != NULL) {
+        buffer = uca_ring_buffer_new_mapped (opts->backing_file, format.size, n_allocated, &error);
+
+        if (buffer == NULL)
+            return error;
+    }
+    else
+        buffer = uca_ring_buffer_new (format.size, n_allocated);
+
     timer = g_timer_new();
 
-    g_print("Start recording: %ix%i at %i bits/pixel\n", roi_width, roi_height, bits);
+    g_print("Start recording: %ix%i at %i bits/pixel\n", format.width, format.height, format.bits);
 
     uca_camera_start_recording(camera, &error);
 
@@ -194,9 +185,18 @@ record_frames (UcaCamera *camera, Options *opts)
 
     uca_camera_stop_recording (camera, &error);
 
+    if (uca_ring_buffer_get_num_overruns (buffer) > 0)
+        g_print ("Ring buffer overran %u times, keeping the last %u frames\n",
+                 uca_ring_buffer_get_num_overruns (buffer),
+                 uca_ring_buffer_get_num_blocks (buffer));
+
 #ifdef HAVE_LIBTIFF
-    if (opts->write_tiff)
-        write_tiff (buffer, opts, roi_width, roi_height, bits);
+    /* TIFF expects packed samples MSB first, leave those as raw frames or use --unpack */
+    if (opts->write_tiff && uca_pixel_format_is_packed (format.pixel_format))
+        g_print ("Cannot write packed pixels as TIFF, writing raw frames\n");
+
+    if (opts->write_tiff && !uca_pixel_format_is_packed (format.pixel_format))
+        write_tiff (buffer, opts, &format);
     else
         write_raw (buffer, opts);
 #else
@@ -221,6 +221,8 @@ main (int argc, char *argv[])
         .n_frames = -1,
         .duration = -1.0,
         .filename = NULL,
+        .backing_file = NULL,
+        .unpack = FALSE,
 #ifdef HAVE_LIBTIFF
         .write_tiff = FALSE,
 #endif
@@ -230,6 +232,8 @@ main (int argc, char *argv[])
         { "num-frames", 'n', 0, G_OPTION_ARG_INT, &opts.n_frames, "Number of frames to acquire", "N" },
         { "duration", 'd', 0, G_OPTION_ARG_DOUBLE, &opts.duration, "Duration in seconds", NULL },
         { "output", 'o', 0, G_OPTION_ARG_STRING, &opts.filename, "Output file name", "FILE" },
+        { "backing-file", 'b', 0, G_OPTION_ARG_STRING, &opts.backing_file, "Buffer frames in FILE instead of memory", "FILE" },
+        { "unpack", 'u', 0, G_OPTION_ARG_NONE, &opts.unpack, "Unpack packed pixels to 16 bit", NULL },
 #ifdef HAVE_LIBTIFF
         { "write-tiff", 't', 0, G_OPTION_ARG_NONE, &opts.write_tiff, "Write as TIFF", NULL },
 #endif
@@ -58,6 +58,7 @@ struct _UcaFileCameraPrivate {
     guint bitdepth;
     GList *fnames;
     GList *current;
+    guint current_index;
 };
 
 static void
@@ -142,6 +143,7 @@ update_fnames (UcaFileCameraPrivate *priv)
 
     priv->fnames = g_list_sort (priv->fnames, (GCompareFunc) g_strcmp0);
     priv->current = priv->fnames;
+    priv->current_index = 0;
 
     if (priv->current != NULL)
         read_tiff_meta_data (priv, (const gchar *) priv->current->data);
@@ -164,6 +166,7 @@ uca_file_camera_start_recording(UcaCamera *camera, GError **error)
     }
 
     priv->current = priv->fnames;
+    priv->current_index = 0;
 }
 
 static void
@@ -196,7 +199,9 @@ uca_file_camera_grab (UcaCamera *camera, gpointer data, GError **error)
         return FALSE;
     }
 
+    uca_camera_set_hardware_sequence (camera, priv->current_index);
     priv->current = g_list_next (priv->current);
+    priv->current_index++;
     return TRUE;
 }
 
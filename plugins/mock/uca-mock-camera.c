@@ -20,9 +20,18 @@
 #include <string.h>
 #include <math.h>
 #include "uca-mock-camera.h"
+#include "uca-enums.h"
 
 #define UCA_MOCK_CAMERA_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), UCA_TYPE_MOCK_CAMERA, UcaMockCameraPrivate))
 
+/* Noise is looked up from a table indexed by 12 random bits */
+#define NOISE_TABLE_BITS    12
+#define NOISE_TABLE_SIZE    (1 << NOISE_TABLE_BITS)
+#define NOISE_CHUNK_SIZE    256
+
+/* Time in microseconds before a deadline from which on we spin, not sleep */
+#define SPIN_TIME           200
+
 static void uca_mock_initable_iface_init (GInitableIface *iface);
 
 G_DEFINE_TYPE_WITH_CODE (UcaMockCamera, uca_mock_camera, UCA_TYPE_CAMERA,
@@ -32,6 +41,11 @@ G_DEFINE_TYPE_WITH_CODE (UcaMockCamera, uca_mock_camera, UCA_TYPE_CAMERA,
 enum {
     PROP_FILL_DATA = N_BASE_PROPERTIES,
     PROP_DEGREE_VALUE,
+    PROP_PIXEL_FORMAT,
+    PROP_MAX_THROUGHPUT,
+    PROP_PIPELINED,
+    PROP_READOUT_TIME,
+    PROP_SENSOR_QUEUE_LENGTH,
     N_PROPERTIES
 };
 
@@ -52,12 +66,19 @@ static const gint mock_overrideables[] = {
 
 static GParamSpec *mock_properties[N_PROPERTIES] = { NULL, };
 
+/* Frame held on the simulated sensor until it is grabbed */
+typedef struct {
+    guint8 *data;
+    guint64 hw_sequence;
+} SensorFrame;
+
 struct _UcaMockCameraPrivate {
     guint width;
     guint height;
     guint bits;
     guint bytes;
     guint max_val;
+    UcaPixelFormat pixel_format;
     guint roi_x, roi_y, roi_width, roi_height;
     gfloat max_frame_rate;
     gdouble exposure_time;
@@ -65,13 +86,29 @@ struct _UcaMockCameraPrivate {
     guint current_frame;
     guint readout_index;
     gboolean fill_data;
+    gboolean max_throughput;
     gdouble degree_value;
     GRand *rand;
+    guint32 noise_table[NOISE_TABLE_SIZE];
 
     gboolean thread_running;
 
     GThread *grab_thread;
-    GAsyncQueue *trigger_queue;
+    GCancellable *grab_thread_cancellable;
+
+    gboolean pipelined;
+    gdouble readout_time;
+    guint sensor_queue_length;
+    GThread *sensor_thread;
+    GCancellable *sensor_cancellable;
+    SensorFrame *sensor_frames;
+    GQueue sensor_free;
+    GQueue sensor_filled;
+
+    GMutex wait_lock;
+    GCond wait_cond;
+    guint n_triggers;
+    gint64 next_deadline;
 };
 
 static const char g_digits[16][20] = {
@@ -201,11 +238,132 @@ print_number (guint8 *buffer, guint number, guint x, guint y, guint n_bytes, gui
     }
 }
 
+/*
+ * Counter-based generator: the random bits of a pixel are a hash of its
+ * position and a per-frame key. Unlike a sequential generator there is no
+ * dependency between pixels, so the compiler can vectorize the hashing.
+ */
+static inline guint32
+hash32 (guint32 x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static gdouble
+normal_cdf (gdouble x)
+{
+    return 0.5 * erfc (-x / G_SQRT2);
+}
+
+/*
+ * Tabulate the inverse normal distribution with the mean and deviation of the
+ * test image, so that drawing a sample is a single lookup.
+ */
+static void
+update_noise_table (UcaMockCameraPrivate *priv)
+{
+    const gdouble mean = ceil (priv->max_val / 2.);
+    const gdouble std = ceil (priv->max_val / 8.);
+
+    for (guint i = 0; i < NOISE_TABLE_SIZE; i++) {
+        gdouble p = (i + 0.5) / NOISE_TABLE_SIZE;
+        gdouble low = -8.0;
+        gdouble high = 8.0;
+        gdouble value;
+
+        while (high - low > 1e-9) {
+            gdouble mid = (low + high) / 2.0;
+
+            if (normal_cdf (mid) < p)
+                low = mid;
+            else
+                high = mid;
+        }
+
+        value = round (low * std + mean);
+        priv->noise_table[i] = (guint32) CLAMP (value, 0.0, (gdouble) priv->max_val);
+    }
+}
+
+static inline void
+hash_chunk (guint32 *hashes, guint32 counter, guint32 key, guint n)
+{
+    for (guint i = 0; i < n; i++)
+        hashes[i] = hash32 ((counter + i) ^ key);
+}
+
+/*
+ * Each hash yields two samples, written with the pixel width. Like
+ * set_pixel(), multi-byte pixels are stored in little endian order.
+ */
+#define DEFINE_NOISE_WRITER(name, type, to_le)                                  \
+static void                                                                     \
+name (const guint32 *table, type *dst, guint n, guint32 counter, guint32 key)  \
+{                                                                               \
+    guint32 hashes[NOISE_CHUNK_SIZE];                                           \
+                                                                                \
+    while (n > 0) {                                                             \
+        guint n_pixels = MIN (n, 2 * NOISE_CHUNK_SIZE);                         \
+        guint n_hashes = (n_pixels + 1) / 2;                                    \
+        guint i;                                                                \
+                                                                                \
+        hash_chunk (hashes, counter, key, n_hashes);                            \
+                                                                                \
+        for (i = 0; i + 1 < n_pixels; i += 2) {                                 \
+            dst[i] = to_le ((type) table[hashes[i / 2] >> (32 - NOISE_TABLE_BITS)]); \
+            dst[i + 1] = to_le ((type) table[hashes[i / 2] & (NOISE_TABLE_SIZE - 1)]); \
+        }                                                                       \
+                                                                                \
+        if (i < n_pixels)                                                       \
+            dst[i] = to_le ((type) table[hashes[i / 2] >> (32 - NOISE_TABLE_BITS)]); \
+                                                                                \
+        dst += n_pixels;                                                        \
+        n -= n_pixels;                                                          \
+        counter += n_hashes;                                                    \
+    }                                                                           \
+}
+
+#define UINT8_TO_LE(x) (x)
+
+DEFINE_NOISE_WRITER (write_noise_8, guint8, UINT8_TO_LE)
+DEFINE_NOISE_WRITER (write_noise_16, guint16, GUINT16_TO_LE)
+DEFINE_NOISE_WRITER (write_noise_32, guint32, GUINT32_TO_LE)
+
+/* Fill the central third of the frame with Gaussian noise */
+static void
+print_noise (UcaMockCameraPrivate *priv, guint8 *buffer)
+{
+    const guint x_start = priv->roi_width / 3;
+    const guint n = (priv->roi_width * 2) / 3 - x_start;
+    guint32 key;
+
+    key = hash32 (g_rand_int (priv->rand));
+
+    for (guint y = (priv->roi_height / 3); y < ((priv->roi_height * 2) / 3); y++) {
+        gsize offset = ((gsize) y * priv->roi_width + x_start) * priv->bytes;
+        guint32 counter = y * priv->roi_width;
+
+        switch (priv->bytes) {
+            case 1:
+                write_noise_8 (priv->noise_table, (guint8 *) (buffer + offset), n, counter, key);
+                break;
+            case 2:
+                write_noise_16 (priv->noise_table, (guint16 *) (buffer + offset), n, counter, key);
+                break;
+            default:
+                write_noise_32 (priv->noise_table, (guint32 *) (buffer + offset), n, counter, key);
+        }
+    }
+}
+
 static void
 print_current_frame (UcaMockCameraPrivate *priv, guint8 *buffer, gboolean prefix)
 {
-    const double mean = (double) ceil (priv->max_val / 2.);
-    const double std = (double) ceil (priv->max_val / 8.);
     guint divisor = 10000000;
     guint number = priv->current_frame;
     int x = 2;
@@ -227,16 +385,114 @@ print_current_frame (UcaMockCameraPrivate *priv, guint8 *buffer, gboolean prefix
         x += DIGIT_WIDTH + 1;
     }
 
-    for (guint y = (priv->roi_height / 3); y < ((priv->roi_height * 2) / 3); y++) {
-        for (guint x = (priv->roi_width / 3); x < ((priv->roi_width * 2) / 3); x++) {
-            double u1 = g_rand_double (priv->rand);
-            double u2 = g_rand_double (priv->rand);
-            double r = sqrt (-2 * log(u1)) * cos(2 * G_PI * u2);
-            set_pixel (buffer, x, y, round (r * std + mean), priv->bytes, priv->max_val, priv->roi_width);
+    print_noise (priv, buffer);
+}
+
+/*
+ * The test image is drawn unpacked into dummy_data, packed formats are packed
+ * while copying it out.
+ */
+static void
+pack_frame (UcaMockCameraPrivate *priv, const guint8 *src, guint8 *dst)
+{
+    for (guint y = 0; y < priv->roi_height; y++) {
+        guint64 acc = 0;
+        guint n_bits = 0;
+
+        for (guint x = 0; x < priv->roi_width; x++, src += 2) {
+            guint value = (src[0] | (src[1] << 8)) & priv->max_val;
+
+            acc |= ((guint64) value) << n_bits;
+            n_bits += priv->bits;
+
+            for (; n_bits >= 8; n_bits -= 8, acc >>= 8)
+                *dst++ = acc & 0xFF;
         }
+
+        /* Rows start at byte boundaries */
+        if (n_bits > 0)
+            *dst++ = acc & 0xFF;
     }
 }
 
+static void
+copy_frame (UcaMockCameraPrivate *priv, const guint8 *src, gpointer data)
+{
+    if (uca_pixel_format_is_packed (priv->pixel_format))
+        pack_frame (priv, src, data);
+    else
+        g_memmove (data, src, priv->roi_width * priv->roi_height * priv->bytes);
+}
+
+static void
+update_pixel_format (UcaMockCameraPrivate *priv)
+{
+    priv->bits = uca_pixel_format_get_bits_per_pixel (priv->pixel_format);
+    priv->bytes = ceil (priv->bits / 8.);
+    priv->max_val = 0;
+
+    for (guint i = 0; i < priv->bits; i++)
+        priv->max_val |= 1U << i;
+
+    update_noise_table (priv);
+}
+
+static void
+uca_mock_camera_get_frame_format (UcaCamera *camera, UcaFrameFormat *format)
+{
+    UcaMockCameraPrivate *priv;
+
+    priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
+    uca_frame_format_init (format, priv->pixel_format, priv->roi_width, priv->roi_height, priv->bits, 0);
+}
+
+static void
+wake_waiters (GCancellable *cancellable, UcaMockCameraPrivate *priv)
+{
+    g_mutex_lock (&priv->wait_lock);
+    g_cond_broadcast (&priv->wait_cond);
+    g_mutex_unlock (&priv->wait_lock);
+}
+
+/*
+ * Wait until the absolute monotonic @deadline. The thread sleeps until shortly
+ * before the deadline, because the wake-up latency of the scheduler is too
+ * coarse for sub-millisecond frame periods, and spins for the rest.
+ */
+static void
+sleep_until (UcaMockCameraPrivate *priv, gint64 deadline, GCancellable *cancellable)
+{
+    g_mutex_lock (&priv->wait_lock);
+
+    while (!g_cancellable_is_cancelled (cancellable) &&
+           g_cond_wait_until (&priv->wait_cond, &priv->wait_lock, deadline - SPIN_TIME))
+        ;
+
+    g_mutex_unlock (&priv->wait_lock);
+
+    while (g_get_monotonic_time () < deadline && !g_cancellable_is_cancelled (cancellable))
+        ;
+}
+
+/*
+ * Advance the frame schedule by @period microseconds and return the deadline
+ * of the next frame. Frames are scheduled against absolute deadlines so that
+ * the time spent between two frames does not accumulate as drift. If we fell
+ * behind by more than a period, the schedule restarts from now rather than
+ * delivering a burst of late frames.
+ */
+static gint64
+advance_deadline (UcaMockCameraPrivate *priv, gint64 period)
+{
+    gint64 now = g_get_monotonic_time ();
+
+    if (priv->next_deadline == 0 || priv->next_deadline < now - period)
+        priv->next_deadline = now;
+
+    priv->next_deadline += period;
+    return priv->next_deadline;
+}
+
 static gpointer
 mock_grab_func(gpointer data)
 {
@@ -247,16 +503,220 @@ mock_grab_func(gpointer data)
     UcaCamera *camera = UCA_CAMERA(mock_camera);
     gdouble fps = 0;
     g_object_get (G_OBJECT (data), "frames-per-second", &fps, NULL);
-    const gulong sleep_time = (gulong) G_USEC_PER_SEC / fps;
+    const gint64 period = (gint64) (G_USEC_PER_SEC / fps);
 
     while (priv->thread_running) {
         camera->grab_func(priv->dummy_data, camera->user_data);
-        g_usleep(sleep_time);
+
+        if (!priv->max_throughput)
+            sleep_until (priv, advance_deadline (priv, period), priv->grab_thread_cancellable);
+    }
+
+    return NULL;
+}
+
+/*
+ * Interrupt the frame period the grab thread is sleeping in and join it.
+ */
+static void
+stop_grab_thread (UcaMockCameraPrivate *priv)
+{
+    priv->thread_running = FALSE;
+    g_cancellable_cancel (priv->grab_thread_cancellable);
+    wake_waiters (priv->grab_thread_cancellable, priv);
+    g_thread_join (priv->grab_thread);
+    g_cancellable_reset (priv->grab_thread_cancellable);
+}
+
+/*
+ * Pipelined sensor model: the exposure of a frame starts as soon as the
+ * previous one was moved to the readout stage, so exposure and readout overlap
+ * and the frame period is max(exposure, readout). Read out frames are held in
+ * a small queue on the sensor, if it is full the frame is lost like on a real
+ * detector and shows up as a gap in the hardware sequence.
+ */
+static gpointer
+sensor_thread (UcaCamera *camera)
+{
+    UcaMockCameraPrivate *priv;
+    UcaCameraSnapshot snapshot;
+    GCancellable *cancellable;
+    gint64 exposure_start;
+    gint64 readout_end;
+
+    priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
+    cancellable = priv->sensor_cancellable;
+    exposure_start = readout_end = g_get_monotonic_time ();
+
+    while (!g_cancellable_is_cancelled (cancellable)) {
+        SensorFrame *frame;
+        gint64 exposure, readout, readout_start, now;
+
+        uca_camera_get_snapshot (camera, &snapshot);
+        exposure = (gint64) (G_USEC_PER_SEC * snapshot.exposure_time);
+        readout = (gint64) (G_USEC_PER_SEC * priv->readout_time);
+
+        g_mutex_lock (&priv->wait_lock);
+
+        if (snapshot.trigger_source == UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE) {
+            while (priv->n_triggers == 0 && !g_cancellable_is_cancelled (cancellable))
+                g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+
+            if (priv->n_triggers > 0)
+                priv->n_triggers--;
+        }
+
+        /* Without a modelled frame period there is nothing to drop */
+        while ((priv->max_throughput || MAX (exposure, readout) == 0) &&
+               g_queue_is_empty (&priv->sensor_free) &&
+               !g_cancellable_is_cancelled (cancellable))
+            g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+
+        frame = g_queue_pop_head (&priv->sensor_free);
+        g_mutex_unlock (&priv->wait_lock);
+
+        if (frame == NULL && g_cancellable_is_cancelled (cancellable))
+            break;
+
+        /*
+         * A trigger starts the exposure, free running we do not catch up on
+         * frames we were too slow for.
+         */
+        now = g_get_monotonic_time ();
+
+        if (snapshot.trigger_source == UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE)
+            exposure_start = MAX (exposure_start, now);
+        else if (exposure_start < now - MAX (exposure, readout))
+            exposure_start = now;
+
+        readout_start = MAX (exposure_start + exposure, readout_end);
+        readout_end = readout_start + readout;
+        exposure_start = readout_start;
+
+        /* Generate the image while the readout time passes */
+        if (frame != NULL && priv->fill_data)
+            print_current_frame (priv, frame->data, FALSE);
+
+        if (!priv->max_throughput)
+            sleep_until (priv, readout_end, cancellable);
+
+        g_mutex_lock (&priv->wait_lock);
+
+        if (frame != NULL) {
+            frame->hw_sequence = priv->current_frame;
+            g_queue_push_tail (&priv->sensor_filled, frame);
+            g_cond_broadcast (&priv->wait_cond);
+        }
+
+        priv->current_frame++;
+        g_mutex_unlock (&priv->wait_lock);
     }
 
     return NULL;
 }
 
+static void
+start_sensor (UcaCamera *camera)
+{
+    UcaMockCameraPrivate *priv;
+    gsize size;
+
+    priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
+    size = priv->roi_width * priv->roi_height * priv->bytes;
+    priv->sensor_frames = g_new0 (SensorFrame, priv->sensor_queue_length);
+
+    for (guint i = 0; i < priv->sensor_queue_length; i++) {
+        priv->sensor_frames[i].data = g_malloc0 (size);
+        g_queue_push_tail (&priv->sensor_free, &priv->sensor_frames[i]);
+    }
+
+    /* Hardware sequence numbers start at zero with every recording */
+    priv->current_frame = 0;
+    g_cancellable_reset (priv->sensor_cancellable);
+    priv->sensor_thread = g_thread_new ("mock-sensor", (GThreadFunc) sensor_thread, camera);
+}
+
+static void
+stop_sensor (UcaMockCameraPrivate *priv)
+{
+    g_cancellable_cancel (priv->sensor_cancellable);
+    wake_waiters (priv->sensor_cancellable, priv);
+    g_thread_join (priv->sensor_thread);
+    priv->sensor_thread = NULL;
+
+    for (guint i = 0; i < priv->sensor_queue_length; i++)
+        g_free (priv->sensor_frames[i].data);
+
+    g_free (priv->sensor_frames);
+    priv->sensor_frames = NULL;
+    g_queue_clear (&priv->sensor_free);
+    g_queue_clear (&priv->sensor_filled);
+}
+
+/*
+ * Wait for the next frame of the sensor and check that it has @hw_sequence.
+ */
+static gboolean
+sensor_frame_follows (UcaMockCameraPrivate *priv, guint64 hw_sequence)
+{
+    SensorFrame *frame;
+
+    g_mutex_lock (&priv->wait_lock);
+
+    while ((frame = g_queue_peek_head (&priv->sensor_filled)) == NULL &&
+           !g_cancellable_is_cancelled (priv->sensor_cancellable))
+        g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+
+    g_mutex_unlock (&priv->wait_lock);
+
+    return frame == NULL || frame->hw_sequence == hw_sequence;
+}
+
+/*
+ * Take the oldest frame from the sensor queue and copy it to @data.
+ */
+static gboolean
+take_sensor_frame (UcaMockCameraPrivate *priv, gpointer data, guint64 *hw_sequence, GCancellable *cancellable, GError **error)
+{
+    SensorFrame *frame = NULL;
+    gulong handler = 0;
+
+    if (cancellable != NULL)
+        handler = g_cancellable_connect (cancellable, G_CALLBACK (wake_waiters), priv, NULL);
+
+    g_mutex_lock (&priv->wait_lock);
+
+    while (!g_cancellable_is_cancelled (cancellable) &&
+           !g_cancellable_is_cancelled (priv->sensor_cancellable) &&
+           (frame = g_queue_pop_head (&priv->sensor_filled)) == NULL)
+        g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+
+    g_mutex_unlock (&priv->wait_lock);
+
+    if (cancellable != NULL)
+        g_cancellable_disconnect (cancellable, handler);
+
+    if (frame == NULL) {
+        if (!g_cancellable_set_error_if_cancelled (cancellable, error))
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
+                         "Sensor stopped");
+
+        return FALSE;
+    }
+
+    if (priv->fill_data)
+        copy_frame (priv, frame->data, data);
+
+    *hw_sequence = frame->hw_sequence;
+
+    g_mutex_lock (&priv->wait_lock);
+    g_queue_push_tail (&priv->sensor_free, frame);
+    g_cond_broadcast (&priv->wait_cond);
+    g_mutex_unlock (&priv->wait_lock);
+
+    return TRUE;
+}
+
 static void
 uca_mock_camera_start_recording(UcaCamera *camera, GError **error)
 {
@@ -265,6 +725,7 @@ uca_mock_camera_start_recording(UcaCamera *camera, GError **error)
     g_return_if_fail(UCA_IS_MOCK_CAMERA(camera));
 
     priv = UCA_MOCK_CAMERA_GET_PRIVATE(camera);
+    priv->next_deadline = 0;
     /* TODO: check that roi_x + roi_width < priv->width */
     priv->dummy_data = (guint8 *) g_malloc0(priv->roi_width * priv->roi_height * priv->bytes);
 
@@ -274,8 +735,12 @@ uca_mock_camera_start_recording(UcaCamera *camera, GError **error)
 
     /*
      * In case asynchronous transfer is requested, we start a new thread that
-     * invokes the grab callback, otherwise nothing will be done here.
+     * invokes the grab callback. Otherwise the pipelined sensor model runs in
+     * its own thread if requested.
      */
+    if (!transfer_async && priv->pipelined)
+        start_sensor (camera);
+
     if (transfer_async) {
         GError *tmp_error = NULL;
         priv->thread_running = TRUE;
@@ -300,17 +765,20 @@ uca_mock_camera_stop_recording(UcaCamera *camera, GError **error)
     g_return_if_fail(UCA_IS_MOCK_CAMERA(camera));
 
     priv = UCA_MOCK_CAMERA_GET_PRIVATE(camera);
-    g_free(priv->dummy_data);
-    priv->dummy_data = NULL;
 
     g_object_get(G_OBJECT(camera),
             "transfer-asynchronously", &transfer_async,
             NULL);
 
-    if (transfer_async) {
-        priv->thread_running = FALSE;
-        g_thread_join(priv->grab_thread);
-    }
+    if (priv->sensor_thread != NULL)
+        stop_sensor (priv);
+
+    /* The grab thread uses dummy_data until it is joined */
+    if (transfer_async)
+        stop_grab_thread (priv);
+
+    g_free(priv->dummy_data);
+    priv->dummy_data = NULL;
 }
 
 static void
@@ -321,40 +789,147 @@ uca_mock_camera_trigger (UcaCamera *camera, GError **error)
     g_return_if_fail(UCA_IS_MOCK_CAMERA (camera));
     priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
 
-    g_async_queue_push (priv->trigger_queue, g_malloc0 (1));
+    g_mutex_lock (&priv->wait_lock);
+    priv->n_triggers++;
+    g_cond_broadcast (&priv->wait_cond);
+    g_mutex_unlock (&priv->wait_lock);
 }
 
+/*
+ * Consume @n_triggers software triggers and wait for @duration seconds like
+ * an exposure would. Without triggers, exposures follow each other on a fixed
+ * schedule. Both waits return early if @cancellable is cancelled.
+ */
 static gboolean
-uca_mock_camera_grab (UcaCamera *camera, gpointer data, GError **error)
+wait_for_exposure (UcaMockCameraPrivate *priv, guint n_triggers, gdouble duration, GCancellable *cancellable, GError **error)
+{
+    gint64 period = (gint64) (G_USEC_PER_SEC * duration);
+    gint64 deadline;
+    gulong handler = 0;
+
+    if (cancellable != NULL)
+        handler = g_cancellable_connect (cancellable, G_CALLBACK (wake_waiters), priv, NULL);
+
+    g_mutex_lock (&priv->wait_lock);
+
+    /* A trigger starts the exposure, the schedule starts over */
+    if (n_triggers > 0)
+        priv->next_deadline = 0;
+
+    while (n_triggers > 0 && !g_cancellable_is_cancelled (cancellable)) {
+        if (priv->n_triggers > 0) {
+            priv->n_triggers--;
+            n_triggers--;
+        }
+        else
+            g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+    }
+
+    deadline = advance_deadline (priv, period);
+    g_mutex_unlock (&priv->wait_lock);
+
+    if (!priv->max_throughput)
+        sleep_until (priv, deadline, cancellable);
+
+    if (cancellable != NULL)
+        g_cancellable_disconnect (cancellable, handler);
+
+    return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+static gboolean
+uca_mock_camera_grab_cancellable (UcaCamera *camera, gpointer data, GCancellable *cancellable, GError **error)
 {
     UcaMockCameraPrivate *priv;
-    UcaCameraTriggerSource trigger_source;
-    gdouble exposure_time;
+    UcaCameraSnapshot snapshot;
 
     g_return_val_if_fail (UCA_IS_MOCK_CAMERA(camera), FALSE);
 
-
     priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
 
-    g_object_get (G_OBJECT (camera),
-                  "exposure-time", &exposure_time,
-                  "trigger-source", &trigger_source, NULL);
+    if (priv->sensor_thread != NULL) {
+        guint64 hw_sequence;
+
+        if (!take_sensor_frame (priv, data, &hw_sequence, cancellable, error))
+            return FALSE;
+
+        uca_camera_set_hardware_sequence (camera, hw_sequence);
+        return TRUE;
+    }
 
-    if (trigger_source == UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE)
-        g_free (g_async_queue_pop (priv->trigger_queue));
+    uca_camera_get_snapshot (camera, &snapshot);
 
-    g_usleep (G_USEC_PER_SEC * exposure_time);
+    if (!wait_for_exposure (priv, snapshot.trigger_source == UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE ? 1 : 0,
+                            snapshot.exposure_time, cancellable, error))
+        return FALSE;
 
     if (priv->fill_data) {
         print_current_frame (priv, priv->dummy_data, FALSE);
-        g_memmove (data, priv->dummy_data, priv->roi_width * priv->roi_height * priv->bytes);
+        copy_frame (priv, priv->dummy_data, data);
     }
 
+    uca_camera_set_hardware_sequence (camera, priv->current_frame);
     priv->current_frame++;
 
     return TRUE;
 }
 
+static gboolean
+uca_mock_camera_grab (UcaCamera *camera, gpointer data, GError **error)
+{
+    return uca_mock_camera_grab_cancellable (camera, data, NULL, error);
+}
+
+static guint
+uca_mock_camera_grab_many (UcaCamera *camera, gpointer *buffers, guint n, GError **error)
+{
+    UcaMockCameraPrivate *priv;
+    UcaCameraSnapshot snapshot;
+
+    g_return_val_if_fail (UCA_IS_MOCK_CAMERA(camera), 0);
+
+    priv = UCA_MOCK_CAMERA_GET_PRIVATE (camera);
+
+    if (priv->sensor_thread != NULL) {
+        guint64 first = 0;
+
+        for (guint i = 0; i < n; i++) {
+            guint64 hw_sequence;
+
+            /* Leave a frame after a gap to the next batch which reports it */
+            if (i > 0 && !sensor_frame_follows (priv, first + i))
+                return i;
+
+            if (!take_sensor_frame (priv, buffers[i], &hw_sequence, NULL, error))
+                return i;
+
+            if (i == 0) {
+                first = hw_sequence;
+                uca_camera_set_hardware_sequence (camera, hw_sequence);
+            }
+        }
+
+        return n;
+    }
+
+    uca_camera_get_snapshot (camera, &snapshot);
+
+    wait_for_exposure (priv, snapshot.trigger_source == UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE ? n : 0,
+                       snapshot.exposure_time * n, NULL, NULL);
+    uca_camera_set_hardware_sequence (camera, priv->current_frame);
+
+    for (guint i = 0; i < n; i++) {
+        if (priv->fill_data) {
+            print_current_frame (priv, priv->dummy_data, FALSE);
+            copy_frame (priv, priv->dummy_data, buffers[i]);
+        }
+
+        priv->current_frame++;
+    }
+
+    return n;
+}
+
 static gboolean
 uca_mock_camera_readout (UcaCamera *camera, gpointer data, guint index, GError **error)
 {
@@ -366,7 +941,7 @@ uca_mock_camera_readout (UcaCamera *camera, gpointer data, guint index, GError *
 
     if (priv->fill_data) {
         print_current_frame (priv, priv->dummy_data, TRUE);
-        g_memmove (data, priv->dummy_data, priv->roi_width * priv->roi_height * priv->bytes);
+        copy_frame (priv, priv->dummy_data, data);
     }
 
     return TRUE;
@@ -405,6 +980,23 @@ uca_mock_camera_set_property (GObject *object, guint property_id, const GValue *
         case PROP_DEGREE_VALUE:
             priv->degree_value = g_value_get_double (value);
             break;
+        case PROP_PIXEL_FORMAT:
+            priv->pixel_format = g_value_get_enum (value);
+            update_pixel_format (priv);
+            g_object_notify (object, "sensor-bitdepth");
+            break;
+        case PROP_MAX_THROUGHPUT:
+            priv->max_throughput = g_value_get_boolean (value);
+            break;
+        case PROP_PIPELINED:
+            priv->pipelined = g_value_get_boolean (value);
+            break;
+        case PROP_READOUT_TIME:
+            priv->readout_time = g_value_get_double (value);
+            break;
+        case PROP_SENSOR_QUEUE_LENGTH:
+            priv->sensor_queue_length = g_value_get_uint (value);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
             return;
@@ -456,6 +1048,21 @@ uca_mock_camera_get_property(GObject *object, guint property_id, GValue *value,
         case PROP_DEGREE_VALUE:
             g_value_set_double (value, priv->degree_value);
             break;
+        case PROP_PIXEL_FORMAT:
+            g_value_set_enum (value, priv->pixel_format);
+            break;
+        case PROP_MAX_THROUGHPUT:
+            g_value_set_boolean (value, priv->max_throughput);
+            break;
+        case PROP_PIPELINED:
+            g_value_set_boolean (value, priv->pipelined);
+            break;
+        case PROP_READOUT_TIME:
+            g_value_set_double (value, priv->readout_time);
+            break;
+        case PROP_SENSOR_QUEUE_LENGTH:
+            g_value_set_uint (value, priv->sensor_queue_length);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -469,13 +1076,17 @@ uca_mock_camera_finalize(GObject *object)
 
     g_rand_free (priv->rand);
 
-    if (priv->thread_running) {
-        priv->thread_running = FALSE;
-        g_thread_join (priv->grab_thread);
-    }
+    if (priv->thread_running)
+        stop_grab_thread (priv);
+
+    if (priv->sensor_thread != NULL)
+        stop_sensor (priv);
 
+    g_object_unref (priv->grab_thread_cancellable);
+    g_object_unref (priv->sensor_cancellable);
     g_free (priv->dummy_data);
-    g_async_queue_unref (priv->trigger_queue);
+    g_mutex_clear (&priv->wait_lock);
+    g_cond_clear (&priv->wait_cond);
 
     G_OBJECT_CLASS (uca_mock_camera_parent_class)->finalize(object);
 }
@@ -490,12 +1101,7 @@ ufo_mock_camera_initable_init (GInitable *initable,
     g_return_val_if_fail (UCA_IS_MOCK_CAMERA (initable), FALSE);
     priv = UCA_MOCK_CAMERA_GET_PRIVATE (UCA_MOCK_CAMERA (initable));
 
-    priv->bytes = ceil (priv->bits / 8.);
-    priv->max_val = 0;
-
-    for (guint i = 0; i < priv->bits; i++) {
-        priv->max_val |= 1 << i;
-    }
+    update_pixel_format (priv);
 
     return TRUE;
 }
@@ -518,8 +1124,11 @@ uca_mock_camera_class_init(UcaMockCameraClass *klass)
     camera_class->start_recording = uca_mock_camera_start_recording;
     camera_class->stop_recording = uca_mock_camera_stop_recording;
     camera_class->grab = uca_mock_camera_grab;
+    camera_class->grab_cancellable = uca_mock_camera_grab_cancellable;
+    camera_class->grab_many = uca_mock_camera_grab_many;
     camera_class->readout = uca_mock_camera_readout;
     camera_class->trigger = uca_mock_camera_trigger;
+    camera_class->get_frame_format = uca_mock_camera_get_frame_format;
 
     for (guint i = 0; mock_overrideables[i] != 0; i++)
         g_object_class_override_property(gobject_class, mock_overrideables[i], uca_camera_props[mock_overrideables[i]]);
@@ -538,6 +1147,41 @@ uca_mock_camera_class_init(UcaMockCameraClass *klass)
             -G_MAXDOUBLE, G_MAXDOUBLE, 0.0,
             G_PARAM_READWRITE);
 
+    mock_properties[PROP_PIXEL_FORMAT] =
+        g_param_spec_enum ("pixel-format",
+            "Pixel format of the simulated sensor",
+            "Pixel format of the simulated sensor, also determines the bit depth",
+            UCA_TYPE_PIXEL_FORMAT, UCA_PIXEL_FORMAT_MONO8,
+            G_PARAM_READWRITE);
+
+    mock_properties[PROP_MAX_THROUGHPUT] =
+        g_param_spec_boolean ("max-throughput",
+            "Deliver frames as fast as possible",
+            "Deliver frames as fast as possible, ignoring exposure time and frame rate",
+            FALSE,
+            G_PARAM_READWRITE);
+
+    mock_properties[PROP_PIPELINED] =
+        g_param_spec_boolean ("pipelined-readout",
+            "Overlap exposure and readout",
+            "Simulate a sensor that exposes the next frame while reading out the current one",
+            FALSE,
+            G_PARAM_READWRITE);
+
+    mock_properties[PROP_READOUT_TIME] =
+        g_param_spec_double ("readout-time",
+            "Readout time in seconds",
+            "Time the simulated sensor needs to read out a frame",
+            0.0, G_MAXDOUBLE, 0.0,
+            G_PARAM_READWRITE);
+
+    mock_properties[PROP_SENSOR_QUEUE_LENGTH] =
+        g_param_spec_uint ("sensor-queue-length",
+            "Number of frames buffered on the sensor",
+            "Number of frames buffered on the sensor before new frames are dropped",
+            1, G_MAXUINT, 4,
+            G_PARAM_READWRITE);
+
     for (guint id = N_BASE_PROPERTIES; id < N_PROPERTIES; id++)
         g_object_class_install_property(gobject_class, id, mock_properties[id]);
 
@@ -556,9 +1200,19 @@ uca_mock_camera_init(UcaMockCamera *self)
     self->priv->roi_y = 0;
     self->priv->max_frame_rate = 100000.0f;
     self->priv->grab_thread = NULL;
+    self->priv->grab_thread_cancellable = g_cancellable_new ();
     self->priv->current_frame = 0;
     self->priv->exposure_time = 0.05;
     self->priv->fill_data = TRUE;
+    self->priv->max_throughput = FALSE;
+    self->priv->next_deadline = 0;
+    self->priv->pipelined = FALSE;
+    self->priv->readout_time = 0.0;
+    self->priv->sensor_queue_length = 4;
+    self->priv->sensor_thread = NULL;
+    self->priv->sensor_cancellable = g_cancellable_new ();
+    g_queue_init (&self->priv->sensor_free);
+    g_queue_init (&self->priv->sensor_filled);
     self->priv->degree_value = 1.0;
 
     self->priv->rand = g_rand_new ();
@@ -573,9 +1227,12 @@ uca_mock_camera_init(UcaMockCamera *self)
     self->priv->roi_width = 512;
     self->priv->roi_height = 512;
     self->priv->bits = 8;
+    self->priv->pixel_format = UCA_PIXEL_FORMAT_MONO8;
     self->priv->bytes = 0;
     self->priv->max_val = 0;
-    self->priv->trigger_queue = g_async_queue_new ();
+    self->priv->n_triggers = 0;
+    g_mutex_init (&self->priv->wait_lock);
+    g_cond_init (&self->priv->wait_cond);
 
     uca_camera_register_unit (UCA_CAMERA (self), "degree-value", UCA_UNIT_DEGREE_CELSIUS);
 }
@@ -0,0 +1,746 @@
+/* Copyright (C) 2026 The libuca contributors
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+   details.
+
+   You should have received a copy of the GNU Lesser General Public License along
+   with this library; if not, write to the Free Software Foundation, Inc., 51
+   Franklin St, Fifth Floor, Boston, MA 02110, USA */
+
+/**
+ * SECTION:uca-camera-group
+ * @Short_description: Synchronized acquisition with several cameras
+ * @Title: UcaCameraGroup
+ *
+ * A #UcaCameraGroup records with all of its member cameras at once. Each
+ * camera is started, read and stopped by its own thread, so that slow
+ * cameras do not delay the others. uca_camera_group_grab() returns one
+ * #UcaFrame per camera, aligned by frame index or time stamp as set with
+ * #UcaCameraGroup:match. Frames without a partner are discarded and the time
+ * difference within each tuple is reported as skew.
+ *
+ * Since: 2.3
+ */
+
+#include <gio/gio.h>
+#include <string.h>
+#include "uca-camera-group.h"
+#include "uca-enums.h"
+
+G_DEFINE_TYPE (UcaCameraGroup, uca_camera_group, G_TYPE_OBJECT)
+
+#define UCA_CAMERA_GROUP_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), UCA_TYPE_CAMERA_GROUP, UcaCameraGroupPrivate))
+
+enum {
+    PROP_GROUP_0,
+    PROP_MATCH,
+    PROP_TOLERANCE,
+    PROP_QUEUE_LENGTH,
+    PROP_GROUP_IS_RECORDING,
+    N_GROUP_PROPERTIES
+};
+
+static GParamSpec *group_properties[N_GROUP_PROPERTIES] = { NULL, };
+
+typedef struct {
+    UcaCameraGroup *group;
+    UcaCamera *camera;
+    GThread *thread;
+    GQueue frames;
+    guint64 next_index;
+    gboolean started;
+    GError *start_error;
+    GError *stop_error;
+} Member;
+
+/* Index since the start of the recording, kept next to each queued frame */
+typedef struct {
+    UcaFrame *frame;
+    guint64 index;
+} QueuedFrame;
+
+struct _UcaCameraGroupPrivate {
+    GPtrArray *members;
+    GMutex lock;
+    GCond cond;
+    GCancellable *cancellable;
+    gboolean is_recording;
+    gboolean stopping;
+    guint n_starting;
+    GError *error;
+
+    UcaCameraGroupMatch match;
+    gdouble tolerance;
+    guint queue_length;
+
+    UcaCameraGroupStats stats;
+    gdouble skew_sum;
+};
+
+static void
+clear_frames (Member *member)
+{
+    QueuedFrame *queued;
+
+    while ((queued = g_queue_pop_head (&member->frames)) != NULL) {
+        uca_frame_unref (queued->frame);
+        g_slice_free (QueuedFrame, queued);
+    }
+}
+
+static void
+member_free (Member *member)
+{
+    clear_frames (member);
+    g_object_unref (member->camera);
+    g_slice_free (Member, member);
+}
+
+static gpointer
+member_thread (Member *member)
+{
+    UcaCameraGroupPrivate *priv;
+    UcaFramePool *pool;
+    GError *error = NULL;
+
+    priv = member->group->priv;
+
+    uca_camera_start_recording (member->camera, &error);
+
+    g_mutex_lock (&priv->lock);
+    member->start_error = error;
+    member->started = error == NULL;
+    priv->n_starting--;
+    g_cond_broadcast (&priv->cond);
+    g_mutex_unlock (&priv->lock);
+
+    if (!member->started)
+        return NULL;
+
+    pool = uca_frame_pool_new (uca_camera_get_frame_size (member->camera), priv->queue_length + 1);
+
+    while (!g_cancellable_is_cancelled (priv->cancellable)) {
+        UcaFrame *frame;
+        UcaFrameInfo *info;
+        QueuedFrame *queued;
+
+        frame = uca_frame_pool_acquire (pool);
+        info = uca_frame_get_info (frame);
+
+        if (!uca_camera_grab_full (member->camera, uca_frame_get_data (frame, NULL), info, priv->cancellable, &error)) {
+            uca_frame_unref (frame);
+            break;
+        }
+
+        queued = g_slice_new (QueuedFrame);
+        queued->frame = frame;
+
+        g_mutex_lock (&priv->lock);
+
+        /* Skip the indices of frames the camera reports as lost */
+        queued->index = member->next_index + info->n_dropped;
+        member->next_index = queued->index + 1;
+        g_queue_push_tail (&member->frames, queued);
+
+        /* Keep the most recent frames if the consumer falls behind */
+        if (g_queue_get_length (&member->frames) > priv->queue_length) {
+            queued = g_queue_pop_head (&member->frames);
+            uca_frame_unref (queued->frame);
+            g_slice_free (QueuedFrame, queued);
+            priv->stats.n_discarded++;
+        }
+
+        g_cond_broadcast (&priv->cond);
+        g_mutex_unlock (&priv->lock);
+    }
+
+    g_mutex_lock (&priv->lock);
+
+    if (error != NULL) {
+        /* Cancellation by uca_camera_group_stop_recording() is no error */
+        if (priv->stopping || priv->error != NULL)
+            g_error_free (error);
+        else
+            priv->error = error;
+
+        error = NULL;
+    }
+
+    g_cond_broadcast (&priv->cond);
+    g_mutex_unlock (&priv->lock);
+
+    uca_camera_stop_recording (member->camera, &member->stop_error);
+    uca_frame_pool_unref (pool);
+
+    return NULL;
+}
+
+static gboolean
+join_members (UcaCameraGroupPrivate *priv, GError **error)
+{
+    gboolean success = TRUE;
+
+    g_mutex_lock (&priv->lock);
+    priv->stopping = TRUE;
+    g_cond_broadcast (&priv->cond);
+    g_mutex_unlock (&priv->lock);
+
+    g_cancellable_cancel (priv->cancellable);
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+
+        g_thread_join (member->thread);
+        member->thread = NULL;
+        clear_frames (member);
+
+        if (member->stop_error != NULL) {
+            if (success)
+                g_propagate_error (error, member->stop_error);
+            else
+                g_error_free (member->stop_error);
+
+            member->stop_error = NULL;
+            success = FALSE;
+        }
+    }
+
+    g_cancellable_reset (priv->cancellable);
+
+    g_mutex_lock (&priv->lock);
+    g_clear_error (&priv->error);
+    priv->is_recording = FALSE;
+    priv->stopping = FALSE;
+    g_mutex_unlock (&priv->lock);
+
+    return success;
+}
+
+/**
+ * uca_camera_group_new:
+ *
+ * Create an empty camera group.
+ *
+ * Returns: (transfer full): A new #UcaCameraGroup
+ * Since: 2.3
+ */
+UcaCameraGroup *
+uca_camera_group_new (void)
+{
+    return UCA_CAMERA_GROUP (g_object_new (UCA_TYPE_CAMERA_GROUP, NULL));
+}
+
+/**
+ * uca_camera_group_add_camera:
+ * @group: A #UcaCameraGroup
+ * @camera: A #UcaCamera that is not recording
+ *
+ * Add @camera to @group. The order in which cameras are added determines the
+ * order of frames in a tuple returned by uca_camera_group_grab().
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_group_add_camera (UcaCameraGroup *group, UcaCamera *camera)
+{
+    UcaCameraGroupPrivate *priv;
+    Member *member;
+
+    g_return_if_fail (UCA_IS_CAMERA_GROUP (group));
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+
+    priv = group->priv;
+    g_mutex_lock (&priv->lock);
+
+    if (priv->is_recording) {
+        g_mutex_unlock (&priv->lock);
+        g_warning ("Cannot add a camera to a recording group");
+        return;
+    }
+
+    member = g_slice_new0 (Member);
+    member->group = group;
+    member->camera = g_object_ref (camera);
+    g_queue_init (&member->frames);
+    g_ptr_array_add (priv->members, member);
+
+    g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * uca_camera_group_get_num_cameras:
+ * @group: A #UcaCameraGroup
+ *
+ * Returns: Number of cameras in @group.
+ * Since: 2.3
+ */
+guint
+uca_camera_group_get_num_cameras (UcaCameraGroup *group)
+{
+    guint n_cameras;
+
+    g_return_val_if_fail (UCA_IS_CAMERA_GROUP (group), 0);
+
+    g_mutex_lock (&group->priv->lock);
+    n_cameras = group->priv->members->len;
+    g_mutex_unlock (&group->priv->lock);
+
+    return n_cameras;
+}
+
+/**
+ * uca_camera_group_get_camera:
+ * @group: A #UcaCameraGroup
+ * @index: Position of the camera
+ *
+ * Returns: (transfer none): The camera that was added at position @index.
+ * Since: 2.3
+ */
+UcaCamera *
+uca_camera_group_get_camera (UcaCameraGroup *group, guint index)
+{
+    UcaCamera *camera = NULL;
+
+    g_return_val_if_fail (UCA_IS_CAMERA_GROUP (group), NULL);
+
+    g_mutex_lock (&group->priv->lock);
+
+    if (index < group->priv->members->len)
+        camera = ((Member *) g_ptr_array_index (group->priv->members, index))->camera;
+
+    g_mutex_unlock (&group->priv->lock);
+
+    g_return_val_if_fail (camera != NULL, NULL);
+    return camera;
+}
+
+/**
+ * uca_camera_group_start_recording:
+ * @group: A #UcaCameraGroup
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Start recording with all cameras in parallel. If one of them fails to
+ * start, the others are stopped again and the first error is returned.
+ *
+ * Returns: %TRUE if all cameras are recording.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_group_start_recording (UcaCameraGroup *group, GError **error)
+{
+    UcaCameraGroupPrivate *priv;
+    GError *start_error = NULL;
+
+    g_return_val_if_fail (UCA_IS_CAMERA_GROUP (group), FALSE);
+
+    priv = group->priv;
+    g_mutex_lock (&priv->lock);
+
+    if (priv->is_recording) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Camera group is already recording");
+        g_mutex_unlock (&priv->lock);
+        return FALSE;
+    }
+
+    memset (&priv->stats, 0, sizeof (UcaCameraGroupStats));
+    priv->skew_sum = 0.0;
+    priv->n_starting = priv->members->len;
+    priv->is_recording = TRUE;
+    g_mutex_unlock (&priv->lock);
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+
+        member->started = FALSE;
+        member->next_index = 0;
+        member->thread = g_thread_new ("group-thread", (GThreadFunc) member_thread, member);
+    }
+
+    g_mutex_lock (&priv->lock);
+
+    while (priv->n_starting > 0)
+        g_cond_wait (&priv->cond, &priv->lock);
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+
+        if (member->start_error != NULL) {
+            if (start_error == NULL)
+                start_error = member->start_error;
+            else
+                g_error_free (member->start_error);
+
+            member->start_error = NULL;
+        }
+    }
+
+    g_mutex_unlock (&priv->lock);
+
+    if (start_error != NULL) {
+        join_members (priv, NULL);
+        g_propagate_error (error, start_error);
+        return FALSE;
+    }
+
+    g_object_notify_by_pspec (G_OBJECT (group), group_properties[PROP_GROUP_IS_RECORDING]);
+    return TRUE;
+}
+
+/**
+ * uca_camera_group_stop_recording:
+ * @group: A #UcaCameraGroup
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Stop recording with all cameras in parallel. Pending grabs are interrupted
+ * and frames not yet delivered are discarded.
+ *
+ * Returns: %TRUE if all cameras stopped without error.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_group_stop_recording (UcaCameraGroup *group, GError **error)
+{
+    UcaCameraGroupPrivate *priv;
+    gboolean success;
+
+    g_return_val_if_fail (UCA_IS_CAMERA_GROUP (group), FALSE);
+
+    priv = group->priv;
+    g_mutex_lock (&priv->lock);
+
+    /* Only one caller gets to join the member threads */
+    if (!priv->is_recording || priv->stopping) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera group is not recording");
+        g_mutex_unlock (&priv->lock);
+        return FALSE;
+    }
+
+    priv->stopping = TRUE;
+    g_mutex_unlock (&priv->lock);
+
+    success = join_members (group->priv, error);
+    g_object_notify_by_pspec (G_OBJECT (group), group_properties[PROP_GROUP_IS_RECORDING]);
+
+    return success;
+}
+
+static gint64
+frame_key (UcaCameraGroupMatch match, QueuedFrame *queued)
+{
+    if (match == UCA_CAMERA_GROUP_MATCH_SEQUENCE)
+        return (gint64) queued->index;
+
+    return uca_frame_get_info (queued->frame)->grab_end;
+}
+
+/*
+ * Discard the head frames that are too old to have a partner at the heads of
+ * the other queues. Returns %TRUE if all heads match. Must be called with the
+ * lock held and all queues non-empty.
+ */
+static gboolean
+align_heads (UcaCameraGroupPrivate *priv)
+{
+    gint64 tolerance = 0;
+    gint64 newest = G_MININT64;
+    gboolean aligned = TRUE;
+
+    if (priv->match == UCA_CAMERA_GROUP_MATCH_TIMESTAMP)
+        tolerance = (gint64) (priv->tolerance * G_USEC_PER_SEC);
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+        newest = MAX (newest, frame_key (priv->match, g_queue_peek_head (&member->frames)));
+    }
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+        QueuedFrame *queued = g_queue_peek_head (&member->frames);
+
+        if (frame_key (priv->match, queued) + tolerance < newest) {
+            g_queue_pop_head (&member->frames);
+            uca_frame_unref (queued->frame);
+            g_slice_free (QueuedFrame, queued);
+            priv->stats.n_discarded++;
+            aligned = FALSE;
+        }
+    }
+
+    return aligned;
+}
+
+static gboolean
+all_queued (UcaCameraGroupPrivate *priv)
+{
+    for (guint i = 0; i < priv->members->len; i++) {
+        if (g_queue_is_empty (&((Member *) g_ptr_array_index (priv->members, i))->frames))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * uca_camera_group_grab:
+ * @group: A #UcaCameraGroup
+ * @frames: (out caller-allocates) (array length=n_frames) (transfer full): Array
+ *  with room for one #UcaFrame per camera
+ * @n_frames: Number of elements of @frames, at least the number of cameras
+ * @skew: (out) (allow-none): Location to store the difference in seconds
+ *  between the earliest and latest frame of the tuple or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Wait until every camera delivered a frame that matches the frames of the
+ * other cameras and store them in @frames in the order the cameras were
+ * added. Release each frame with uca_frame_unref().
+ *
+ * Returns: %TRUE if @frames holds a new tuple, %FALSE if a camera failed or
+ *  the recording was stopped.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_group_grab (UcaCameraGroup *group, UcaFrame **frames, guint n_frames, gdouble *skew, GError **error)
+{
+    UcaCameraGroupPrivate *priv;
+    gint64 first = G_MAXINT64;
+    gint64 last = G_MININT64;
+    gdouble tuple_skew;
+
+    g_return_val_if_fail (UCA_IS_CAMERA_GROUP (group), FALSE);
+    g_return_val_if_fail (frames != NULL, FALSE);
+
+    priv = group->priv;
+    g_mutex_lock (&priv->lock);
+
+    if (!priv->is_recording || priv->members->len == 0) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera group is not recording");
+        g_mutex_unlock (&priv->lock);
+        return FALSE;
+    }
+
+    if (n_frames < priv->members->len) {
+        g_critical ("%u frames cannot hold a tuple of %u cameras", n_frames, priv->members->len);
+        g_mutex_unlock (&priv->lock);
+        return FALSE;
+    }
+
+    while (!all_queued (priv) || !align_heads (priv)) {
+        if (priv->error != NULL) {
+            g_propagate_error (error, g_error_copy (priv->error));
+            g_mutex_unlock (&priv->lock);
+            return FALSE;
+        }
+
+        if (priv->stopping) {
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
+                         "Camera group stopped recording");
+            g_mutex_unlock (&priv->lock);
+            return FALSE;
+        }
+
+        if (!all_queued (priv))
+            g_cond_wait (&priv->cond, &priv->lock);
+    }
+
+    for (guint i = 0; i < priv->members->len; i++) {
+        Member *member = g_ptr_array_index (priv->members, i);
+        QueuedFrame *queued = g_queue_pop_head (&member->frames);
+        gint64 timestamp = uca_frame_get_info (queued->frame)->grab_end;
+
+        first = MIN (first, timestamp);
+        last = MAX (last, timestamp);
+        frames[i] = queued->frame;
+        g_slice_free (QueuedFrame, queued);
+    }
+
+    tuple_skew = (gdouble) (last - first) / G_USEC_PER_SEC;
+    priv->stats.n_tuples++;
+    priv->skew_sum += tuple_skew;
+    priv->stats.mean_skew = priv->skew_sum / priv->stats.n_tuples;
+    priv->stats.max_skew = MAX (priv->stats.max_skew, tuple_skew);
+
+    g_mutex_unlock (&priv->lock);
+
+    if (skew != NULL)
+        *skew = tuple_skew;
+
+    return TRUE;
+}
+
+/**
+ * uca_camera_group_get_stats:
+ * @group: A #UcaCameraGroup
+ * @stats: (out caller-allocates): Location to store the statistics
+ *
+ * Get tuple and skew statistics of the current or last recording.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_group_get_stats (UcaCameraGroup *group, UcaCameraGroupStats *stats)
+{
+    g_return_if_fail (UCA_IS_CAMERA_GROUP (group));
+    g_return_if_fail (stats != NULL);
+
+    g_mutex_lock (&group->priv->lock);
+    *stats = group->priv->stats;
+    g_mutex_unlock (&group->priv->lock);
+}
+
+static void
+uca_camera_group_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+    UcaCameraGroupPrivate *priv = UCA_CAMERA_GROUP_GET_PRIVATE (object);
+    gboolean is_recording;
+
+    g_mutex_lock (&priv->lock);
+    is_recording = priv->is_recording;
+    g_mutex_unlock (&priv->lock);
+
+    if (is_recording) {
+        g_warning ("You cannot change properties during data acquisition");
+        return;
+    }
+
+    switch (property_id) {
+        case PROP_MATCH:
+            priv->match = (UcaCameraGroupMatch) g_value_get_enum (value);
+            break;
+        case PROP_TOLERANCE:
+            priv->tolerance = g_value_get_double (value);
+            break;
+        case PROP_QUEUE_LENGTH:
+            priv->queue_length = g_value_get_uint (value);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+uca_camera_group_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+    UcaCameraGroupPrivate *priv = UCA_CAMERA_GROUP_GET_PRIVATE (object);
+
+    switch (property_id) {
+        case PROP_MATCH:
+            g_value_set_enum (value, priv->match);
+            break;
+        case PROP_TOLERANCE:
+            g_value_set_double (value, priv->tolerance);
+            break;
+        case PROP_QUEUE_LENGTH:
+            g_value_set_uint (value, priv->queue_length);
+            break;
+        case PROP_GROUP_IS_RECORDING:
+            g_mutex_lock (&priv->lock);
+            g_value_set_boolean (value, priv->is_recording);
+            g_mutex_unlock (&priv->lock);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+uca_camera_group_dispose (GObject *object)
+{
+    UcaCameraGroupPrivate *priv;
+
+    priv = UCA_CAMERA_GROUP_GET_PRIVATE (object);
+
+    if (priv->is_recording)
+        join_members (priv, NULL);
+
+    g_ptr_array_set_size (priv->members, 0);
+
+    G_OBJECT_CLASS (uca_camera_group_parent_class)->dispose (object);
+}
+
+static void
+uca_camera_group_finalize (GObject *object)
+{
+    UcaCameraGroupPrivate *priv;
+
+    priv = UCA_CAMERA_GROUP_GET_PRIVATE (object);
+
+    g_ptr_array_free (priv->members, TRUE);
+    g_object_unref (priv->cancellable);
+    g_mutex_clear (&priv->lock);
+    g_cond_clear (&priv->cond);
+
+    G_OBJECT_CLASS (uca_camera_group_parent_class)->finalize (object);
+}
+
+static void
+uca_camera_group_class_init (UcaCameraGroupClass *klass)
+{
+    GObjectClass *oclass = G_OBJECT_CLASS (klass);
+
+    oclass->set_property = uca_camera_group_set_property;
+    oclass->get_property = uca_camera_group_get_property;
+    oclass->dispose = uca_camera_group_dispose;
+    oclass->finalize = uca_camera_group_finalize;
+
+    group_properties[PROP_MATCH] =
+        g_param_spec_enum ("match",
+            "How frames are aligned",
+            "How frames of the member cameras are aligned to tuples",
+            UCA_TYPE_CAMERA_GROUP_MATCH, UCA_CAMERA_GROUP_MATCH_SEQUENCE,
+            G_PARAM_READWRITE);
+
+    group_properties[PROP_TOLERANCE] =
+        g_param_spec_double ("tolerance",
+            "Time stamp tolerance in seconds",
+            "Largest time stamp difference of frames in a tuple when matching by time stamp",
+            0.0, G_MAXDOUBLE, 0.001,
+            G_PARAM_READWRITE);
+
+    group_properties[PROP_QUEUE_LENGTH] =
+        g_param_spec_uint ("queue-length",
+            "Number of frames queued per camera",
+            "Number of frames queued per camera before the oldest is discarded",
+            1, G_MAXUINT, 8,
+            G_PARAM_READWRITE);
+
+    group_properties[PROP_GROUP_IS_RECORDING] =
+        g_param_spec_boolean ("is-recording",
+            "Is group recording",
+            "Is group recording",
+            FALSE,
+            G_PARAM_READABLE);
+
+    for (guint i = PROP_GROUP_0 + 1; i < N_GROUP_PROPERTIES; i++)
+        g_object_class_install_property (oclass, i, group_properties[i]);
+
+    g_type_class_add_private (klass, sizeof (UcaCameraGroupPrivate));
+}
+
+static void
+uca_camera_group_init (UcaCameraGroup *group)
+{
+    UcaCameraGroupPrivate *priv;
+
+    group->priv = priv = UCA_CAMERA_GROUP_GET_PRIVATE (group);
+    priv->members = g_ptr_array_new_with_free_func ((GDestroyNotify) member_free);
+    priv->cancellable = g_cancellable_new ();
+    priv->is_recording = FALSE;
+    priv->stopping = FALSE;
+    priv->error = NULL;
+    priv->match = UCA_CAMERA_GROUP_MATCH_SEQUENCE;
+    priv->tolerance = 0.001;
+    priv->queue_length = 8;
+
+    g_mutex_init (&priv->lock);
+    g_cond_init (&priv->cond);
+}
@@ -0,0 +1,103 @@
+#ifndef UCA_CAMERA_GROUP_H
+#define UCA_CAMERA_GROUP_H
+
+#include <glib-object.h>
+#include "uca-camera.h"
+
+G_BEGIN_DECLS
+
+#define UCA_TYPE_CAMERA_GROUP             (uca_camera_group_get_type())
+#define UCA_CAMERA_GROUP(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), UCA_TYPE_CAMERA_GROUP, UcaCameraGroup))
+#define UCA_IS_CAMERA_GROUP(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), UCA_TYPE_CAMERA_GROUP))
+#define UCA_CAMERA_GROUP_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), UCA_TYPE_CAMERA_GROUP, UcaCameraGroupClass))
+#define UCA_IS_CAMERA_GROUP_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), UCA_TYPE_CAMERA_GROUP))
+#define UCA_CAMERA_GROUP_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), UCA_TYPE_CAMERA_GROUP, UcaCameraGroupClass))
+
+typedef struct _UcaCameraGroup           UcaCameraGroup;
+typedef struct _UcaCameraGroupClass      UcaCameraGroupClass;
+typedef struct _UcaCameraGroupPrivate    UcaCameraGroupPrivate;
+
+/**
+ * UcaCameraGroupMatch:
+ * @UCA_CAMERA_GROUP_MATCH_SEQUENCE: Frames with the same index since the
+ *  start of the recording belong together. Frames the camera reports as
+ *  dropped are taken into account.
+ * @UCA_CAMERA_GROUP_MATCH_TIMESTAMP: Frames received within
+ *  #UcaCameraGroup:tolerance of each other belong together
+ *
+ * How frames of the member cameras are aligned to tuples.
+ *
+ * Since: 2.3
+ */
+typedef enum {
+    UCA_CAMERA_GROUP_MATCH_SEQUENCE,
+    UCA_CAMERA_GROUP_MATCH_TIMESTAMP
+} UcaCameraGroupMatch;
+
+/**
+ * UcaCameraGroupStats:
+ * @n_tuples: Number of tuples delivered by uca_camera_group_grab()
+ * @n_discarded: Number of frames discarded because no matching frame of the
+ *  other cameras arrived or because the consumer was too slow
+ * @mean_skew: Mean difference in seconds between the earliest and latest
+ *  frame of a tuple
+ * @max_skew: Largest difference in seconds between the earliest and latest
+ *  frame of a tuple
+ *
+ * Statistics of the current or last recording, see
+ * uca_camera_group_get_stats().
+ *
+ * Since: 2.3
+ */
+typedef struct {
+    guint64 n_tuples;
+    guint64 n_discarded;
+    gdouble mean_skew;
+    gdouble max_skew;
+} UcaCameraGroupStats;
+
+/**
+ * UcaCameraGroup:
+ *
+ * Records with several cameras at once. The contents of the #UcaCameraGroup
+ * structure are private and should only be accessed via the provided API.
+ */
+struct _UcaCameraGroup {
+    /*< private >*/
+    GObject parent_instance;
+
+    UcaCameraGroupPrivate *priv;
+};
+
+/**
+ * UcaCameraGroupClass:
+ *
+ * #UcaCameraGroup class
+ */
+struct _UcaCameraGroupClass {
+    /*< private >*/
+    GObjectClass parent_class;
+};
+
+UcaCameraGroup *    uca_camera_group_new                (void);
+void                uca_camera_group_add_camera         (UcaCameraGroup     *group,
+                                                         UcaCamera          *camera);
+guint               uca_camera_group_get_num_cameras    (UcaCameraGroup     *group);
+UcaCamera *         uca_camera_group_get_camera         (UcaCameraGroup     *group,
+                                                         guint               index);
+gboolean            uca_camera_group_start_recording    (UcaCameraGroup     *group,
+                                                         GError            **error);
+gboolean            uca_camera_group_stop_recording     (UcaCameraGroup     *group,
+                                                         GError            **error);
+gboolean            uca_camera_group_grab               (UcaCameraGroup     *group,
+                                                         UcaFrame          **frames,
+                                                         guint               n_frames,
+                                                         gdouble            *skew,
+                                                         GError            **error);
+void                uca_camera_group_get_stats          (UcaCameraGroup     *group,
+                                                         UcaCameraGroupStats *stats);
+GType               uca_camera_group_get_type           (void);
+
+G_END_DECLS
+
+#endif
@@ -30,16 +30,28 @@
 #endif
 
 #include <glib.h>
+#include <glib-unix.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#else
+#include <fcntl.h>
+#endif
 #include "compat.h"
 #include "uca-camera.h"
 #include "uca-ring-buffer.h"
+#include "uca-unpack.h"
+#include "uca-trace.h"
 #include "uca-enums.h"
 
 #define UCA_CAMERA_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), UCA_TYPE_CAMERA, UcaCameraPrivate))
 
 G_DEFINE_TYPE(UcaCamera, uca_camera, G_TYPE_OBJECT)
+G_DEFINE_BOXED_TYPE(UcaFrameFormat, uca_frame_format, uca_frame_format_copy, uca_frame_format_free)
+G_DEFINE_BOXED_TYPE(UcaCameraReadoutRange, uca_camera_readout_range, uca_camera_readout_range_ref, uca_camera_readout_range_free)
 
 /**
  * UcaCameraTriggerSource:
@@ -66,6 +78,7 @@ G_DEFINE_TYPE(UcaCamera, uca_camera, G_TYPE_OBJECT)
  *  argument of the write method is not correct.
  * @UCA_CAMERA_ERROR_TIMEOUT: Generic timeout error
  * @UCA_CAMERA_ERROR_END_OF_STREAM: Data stream has ended.
+ * @UCA_CAMERA_ERROR_INVALID_VALUE: Property cannot be set to the given value
  */
 GQuark uca_camera_error_quark()
 {
@@ -132,11 +145,23 @@ const gchar *uca_camera_props[N_BASE_PROPERTIES] = {
     "is-readout",
     "buffered",
     "num-buffers",
+    "grab-timeout",
+    "overrun-policy",
+    "buffer-alloc-flags",
+    "buffer-numa-node",
+    "buffer-unpack",
+    "dispatch-threads",
+    "dispatch-queue-length",
+    "dispatch-ordered",
+    "frames-grabbed",
+    "frames-dropped",
+    "frames-overrun",
+    "bytes-transferred",
 };
 
 static GParamSpec *camera_properties[N_BASE_PROPERTIES] = { NULL, };
-static GStaticMutex access_lock = G_STATIC_MUTEX_INIT;
 static gboolean str_to_boolean (const gchar *s);
+static void async_worker (GTask *task, gpointer unused);
 
 #define DEFINE_CAST(suffix, trans_func)                 \
 static void                                             \
@@ -158,6 +183,43 @@ DEFINE_CAST (double,    atof)
 DEFINE_CAST (boolean,   str_to_boolean)
 
 
+typedef struct {
+    guint64 last_hw_sequence;
+    guint64 n_delivered;
+} FrameAccount;
+
+struct _UcaCameraSubscriber {
+    UcaCamera *camera;
+    UcaCameraSubscriberPolicy policy;
+    GQueue *pending;
+    guint64 last_sequence;
+    gboolean has_last;
+    FrameAccount account;
+};
+
+struct _UcaCameraReadoutRange {
+    gint ref_count;
+    UcaCamera *camera;
+    UcaRingBuffer *ring_buffer;
+    GThread *thread;
+    GMutex lock;
+    GCond cond;
+    GCancellable *cancellable;
+    gulong cancelled_id;
+    UcaCameraProgressFunc progress;
+    gpointer user_data;
+    guint first;
+    guint count;
+    gboolean stop;
+    gboolean done;
+    GError *error;
+};
+
+typedef struct {
+    gpointer data;
+    gint64 enqueue_time;
+} DispatchSlot;
+
 struct _UcaCameraPrivate {
     gboolean cancelling_recording;
     gboolean is_recording;
@@ -167,6 +229,57 @@ struct _UcaCameraPrivate {
     guint num_buffers;
     GThread *read_thread;
     UcaRingBuffer *ring_buffer;
+    GMutex buffer_mutex;
+    GCond buffer_cond;
+    GError *buffer_error;
+    gboolean buffer_thread_done;
+    gdouble grab_timeout;
+    UcaRingBufferOverrunPolicy overrun_policy;
+    UcaRingBufferAllocFlags buffer_alloc_flags;
+    gint buffer_numa_node;
+    gboolean buffer_unpack;
+    UcaFrameFormat unpack_format;
+    gpointer unpack_buffer;
+    guint64 sequence;
+    guint64 hw_sequence;
+    gboolean has_hw_sequence;
+    FrameAccount account;
+    GList *subscribers;
+    gpointer latest_block;
+    guint64 latest_sequence;
+    guint dispatch_threads;
+    guint dispatch_queue_length;
+    gboolean dispatch_ordered;
+    GThreadPool *dispatch_pool;
+    GThreadPool *async_pool;
+    GAsyncQueue *dispatch_free;
+    DispatchSlot *dispatch_slots;
+    UcaCameraGrabFunc dispatch_func;
+    gpointer dispatch_user_data;
+    gsize dispatch_frame_size;
+    GMutex dispatch_lock;
+    UcaCameraDispatchStats dispatch_stats;
+    GMutex stats_lock;
+    gint stats_seq;
+    gint consumer_stats_seq;
+    UcaCameraStats stats;
+    gsize stats_frame_size;
+    guint64 stats_last_hw_sequence;
+    guint64 stop_time;
+    gint64 access_wait_start;
+    GMutex access_lock;
+    GMutex state_lock;
+    GMutex grab_lock;
+    GMutex trigger_lock;
+    GMutex snapshot_lock;
+    GMutex frame_pool_lock;
+    UcaFramePool *frame_pool;
+    GCancellable *grab_cancellable;
+    gint frame_fd[2];
+    gboolean frame_fd_signalled;
+    UcaCameraSnapshot snapshot;
+    gboolean snapshot_valid;
+    guint snapshot_serial;
     UcaCameraTriggerSource trigger_source;
     UcaCameraTriggerType trigger_type;
 };
@@ -229,6 +342,38 @@ uca_camera_set_property (GObject *object, guint property_id, const GValue *value
             priv->num_buffers = g_value_get_uint (value);
             break;
 
+        case PROP_GRAB_TIMEOUT:
+            priv->grab_timeout = g_value_get_double (value);
+            break;
+
+        case PROP_OVERRUN_POLICY:
+            priv->overrun_policy = g_value_get_enum (value);
+            break;
+
+        case PROP_BUFFER_ALLOC_FLAGS:
+            priv->buffer_alloc_flags = g_value_get_flags (value);
+            break;
+
+        case PROP_BUFFER_NUMA_NODE:
+            priv->buffer_numa_node = g_value_get_int (value);
+            break;
+
+        case PROP_BUFFER_UNPACK:
+            priv->buffer_unpack = g_value_get_boolean (value);
+            break;
+
+        case PROP_DISPATCH_THREADS:
+            priv->dispatch_threads = g_value_get_uint (value);
+            break;
+
+        case PROP_DISPATCH_QUEUE_LENGTH:
+            priv->dispatch_queue_length = g_value_get_uint (value);
+            break;
+
+        case PROP_DISPATCH_ORDERED:
+            priv->dispatch_ordered = g_value_get_boolean (value);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
     }
@@ -311,6 +456,58 @@ uca_camera_get_property(GObject *object, guint property_id, GValue *value, GPara
             g_value_set_uint (value, priv->num_buffers);
             break;
 
+        case PROP_GRAB_TIMEOUT:
+            g_value_set_double (value, priv->grab_timeout);
+            break;
+
+        case PROP_OVERRUN_POLICY:
+            g_value_set_enum (value, priv->overrun_policy);
+            break;
+
+        case PROP_BUFFER_ALLOC_FLAGS:
+            g_value_set_flags (value, priv->buffer_alloc_flags);
+            break;
+
+        case PROP_BUFFER_NUMA_NODE:
+            g_value_set_int (value, priv->buffer_numa_node);
+            break;
+
+        case PROP_BUFFER_UNPACK:
+            g_value_set_boolean (value, priv->buffer_unpack);
+            break;
+
+        case PROP_DISPATCH_THREADS:
+            g_value_set_uint (value, priv->dispatch_threads);
+            break;
+
+        case PROP_DISPATCH_QUEUE_LENGTH:
+            g_value_set_uint (value, priv->dispatch_queue_length);
+            break;
+
+        case PROP_DISPATCH_ORDERED:
+            g_value_set_boolean (value, priv->dispatch_ordered);
+            break;
+
+        case PROP_FRAMES_GRABBED:
+        case PROP_FRAMES_DROPPED:
+        case PROP_FRAMES_OVERRUN:
+        case PROP_BYTES_TRANSFERRED:
+            {
+                UcaCameraStats stats;
+
+                uca_camera_get_stats (UCA_CAMERA (object), &stats);
+
+                if (property_id == PROP_FRAMES_GRABBED)
+                    g_value_set_uint64 (value, stats.n_grabbed);
+                else if (property_id == PROP_FRAMES_DROPPED)
+                    g_value_set_uint64 (value, stats.n_dropped);
+                else if (property_id == PROP_FRAMES_OVERRUN)
+                    g_value_set_uint64 (value, stats.n_overruns);
+                else
+                    g_value_set_uint64 (value, stats.n_bytes);
+            }
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
     }
@@ -328,12 +525,20 @@ uca_camera_dispose (GObject *object)
         priv->ring_buffer = NULL;
     }
 
+    if (priv->frame_pool != NULL) {
+        uca_frame_pool_unref (priv->frame_pool);
+        priv->frame_pool = NULL;
+    }
+
+    g_clear_object (&priv->grab_cancellable);
+
     G_OBJECT_CLASS (uca_camera_parent_class)->dispose (object);
 }
 
 static void
 uca_camera_finalize (GObject *object)
 {
+    UcaCameraPrivate *priv;
     GParamSpec **props;
     guint n_props;
 
@@ -346,9 +551,46 @@ uca_camera_finalize (GObject *object)
 
     g_free (props);
 
+    priv = UCA_CAMERA_GET_PRIVATE (object);
+
+    /* Pending tasks hold a reference, so nothing is left to wait for */
+    g_thread_pool_free (priv->async_pool, FALSE, FALSE);
+
+    if (priv->frame_fd[0] >= 0) {
+        close (priv->frame_fd[0]);
+
+        if (priv->frame_fd[1] != priv->frame_fd[0])
+            close (priv->frame_fd[1]);
+    }
+
+    g_mutex_clear (&priv->dispatch_lock);
+    g_mutex_clear (&priv->stats_lock);
+    g_mutex_clear (&priv->buffer_mutex);
+    g_cond_clear (&priv->buffer_cond);
+    g_mutex_clear (&priv->access_lock);
+    g_mutex_clear (&priv->state_lock);
+    g_mutex_clear (&priv->grab_lock);
+    g_mutex_clear (&priv->trigger_lock);
+    g_mutex_clear (&priv->snapshot_lock);
+    g_mutex_clear (&priv->frame_pool_lock);
+
     G_OBJECT_CLASS (uca_camera_parent_class)->finalize (object);
 }
 
+static void
+uca_camera_default_get_frame_format (UcaCamera *camera, UcaFrameFormat *format)
+{
+    guint width, height, bitdepth;
+
+    g_object_get (camera,
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  "sensor-bitdepth", &bitdepth,
+                  NULL);
+
+    uca_frame_format_init (format, uca_pixel_format_from_bitdepth (bitdepth), width, height, bitdepth, 0);
+}
+
 static void
 uca_camera_class_init (UcaCameraClass *klass)
 {
@@ -361,6 +603,10 @@ uca_camera_class_init (UcaCameraClass *klass)
     klass->start_recording = NULL;
     klass->stop_recording = NULL;
     klass->grab = NULL;
+    klass->grab_many = NULL;
+    klass->get_frame_format = uca_camera_default_get_frame_format;
+    klass->set_properties = NULL;
+    klass->grab_cancellable = NULL;
     klass->readout = NULL;
     klass->write = NULL;
 
@@ -546,12 +792,118 @@ uca_camera_class_init (UcaCameraClass *klass)
             0, G_MAXUINT, 4,
             G_PARAM_READWRITE);
 
+    camera_properties[PROP_GRAB_TIMEOUT] =
+        g_param_spec_double(uca_camera_props[PROP_GRAB_TIMEOUT],
+            "Timeout of buffered grabs in seconds",
+            "Timeout of buffered grabs in seconds, 0 waits forever",
+            0.0, G_MAXDOUBLE, 0.0,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_OVERRUN_POLICY] =
+        g_param_spec_enum(uca_camera_props[PROP_OVERRUN_POLICY],
+            "What happens when the buffer thread catches up with the reader",
+            "What happens when the buffer thread catches up with the reader",
+            UCA_TYPE_RING_BUFFER_OVERRUN_POLICY, UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_BUFFER_ALLOC_FLAGS] =
+        g_param_spec_flags(uca_camera_props[PROP_BUFFER_ALLOC_FLAGS],
+            "How the ring buffer memory is allocated",
+            "How the ring buffer memory is allocated",
+            UCA_TYPE_RING_BUFFER_ALLOC_FLAGS, UCA_RING_BUFFER_ALLOC_DEFAULT,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_BUFFER_NUMA_NODE] =
+        g_param_spec_int(uca_camera_props[PROP_BUFFER_NUMA_NODE],
+            "NUMA node of the ring buffer memory",
+            "NUMA node of the ring buffer memory, -1 for no binding",
+            -1, G_MAXINT, -1,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_BUFFER_UNPACK] =
+        g_param_spec_boolean(uca_camera_props[PROP_BUFFER_UNPACK],
+            "Unpack packed pixel formats in the ring buffer",
+            "Unpack packed pixel formats to 16 bit before frames enter the ring buffer",
+            FALSE, G_PARAM_READWRITE);
+
+    camera_properties[PROP_DISPATCH_THREADS] =
+        g_param_spec_uint(uca_camera_props[PROP_DISPATCH_THREADS],
+            "Number of threads running the grab callback",
+            "Number of threads running the grab callback, 0 calls it from the acquisition thread",
+            0, G_MAXUINT, 0,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_DISPATCH_QUEUE_LENGTH] =
+        g_param_spec_uint(uca_camera_props[PROP_DISPATCH_QUEUE_LENGTH],
+            "Number of frames the dispatch queue can hold",
+            "Number of frames the dispatch queue can hold",
+            1, G_MAXUINT, 4,
+            G_PARAM_READWRITE);
+
+    camera_properties[PROP_DISPATCH_ORDERED] =
+        g_param_spec_boolean(uca_camera_props[PROP_DISPATCH_ORDERED],
+            "TRUE if grab callbacks must run in frame order",
+            "TRUE if grab callbacks must run in frame order",
+            FALSE, G_PARAM_READWRITE);
+
+    camera_properties[PROP_FRAMES_GRABBED] =
+        g_param_spec_uint64(uca_camera_props[PROP_FRAMES_GRABBED],
+            "Number of frames grabbed since recording started",
+            "Number of frames grabbed since recording started",
+            0, G_MAXUINT64, 0,
+            G_PARAM_READABLE);
+
+    camera_properties[PROP_FRAMES_DROPPED] =
+        g_param_spec_uint64(uca_camera_props[PROP_FRAMES_DROPPED],
+            "Number of frames lost by the camera since recording started",
+            "Number of frames lost by the camera since recording started",
+            0, G_MAXUINT64, 0,
+            G_PARAM_READABLE);
+
+    camera_properties[PROP_FRAMES_OVERRUN] =
+        g_param_spec_uint64(uca_camera_props[PROP_FRAMES_OVERRUN],
+            "Number of ring buffer overruns since recording started",
+            "Number of ring buffer overruns since recording started",
+            0, G_MAXUINT64, 0,
+            G_PARAM_READABLE);
+
+    camera_properties[PROP_BYTES_TRANSFERRED] =
+        g_param_spec_uint64(uca_camera_props[PROP_BYTES_TRANSFERRED],
+            "Number of bytes transferred since recording started",
+            "Number of bytes transferred since recording started",
+            0, G_MAXUINT64, 0,
+            G_PARAM_READABLE);
+
     for (guint id = PROP_0 + 1; id < N_BASE_PROPERTIES; id++)
         g_object_class_install_property(gobject_class, id, camera_properties[id]);
 
+    /* Allow setting properties from strings, see uca_camera_parse_arg_props() */
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UCHAR,   value_transform_uchar);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_INT,     value_transform_int);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UINT,    value_transform_uint);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UINT64,  value_transform_uint64);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_LONG,    value_transform_long);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_ULONG,   value_transform_ulong);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_FLOAT,   value_transform_float);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_DOUBLE,  value_transform_double);
+    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_BOOLEAN, value_transform_boolean);
+
     g_type_class_add_private(klass, sizeof(UcaCameraPrivate));
 }
 
+/*
+ * Any property can change the frame layout of a plugin, so every notification
+ * invalidates the snapshot.
+ */
+static void
+invalidate_snapshot (UcaCamera *camera, GParamSpec *pspec, gpointer user_data)
+{
+    g_mutex_lock (&camera->priv->snapshot_lock);
+    camera->priv->snapshot_valid = FALSE;
+    camera->priv->snapshot_serial++;
+    g_mutex_unlock (&camera->priv->snapshot_lock);
+}
+
 static void
 uca_camera_init (UcaCamera *camera)
 {
@@ -569,6 +921,43 @@ uca_camera_init (UcaCamera *camera)
     camera->priv->buffered = FALSE;
     camera->priv->num_buffers = 4;
     camera->priv->ring_buffer = NULL;
+    camera->priv->buffer_error = NULL;
+    camera->priv->buffer_thread_done = FALSE;
+    camera->priv->grab_timeout = 0.0;
+    camera->priv->overrun_policy = UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST;
+    camera->priv->buffer_alloc_flags = UCA_RING_BUFFER_ALLOC_DEFAULT;
+    camera->priv->buffer_numa_node = -1;
+    camera->priv->buffer_unpack = FALSE;
+    camera->priv->unpack_buffer = NULL;
+    camera->priv->subscribers = NULL;
+    camera->priv->latest_block = NULL;
+    camera->priv->dispatch_threads = 0;
+    camera->priv->dispatch_queue_length = 4;
+    camera->priv->dispatch_ordered = FALSE;
+    camera->priv->dispatch_pool = NULL;
+    /* Threads are only spawned for asynchronous calls */
+    camera->priv->async_pool = g_thread_pool_new ((GFunc) async_worker, NULL, -1, FALSE, NULL);
+    camera->priv->access_wait_start = 0;
+    camera->priv->frame_pool = NULL;
+    camera->priv->grab_cancellable = g_cancellable_new ();
+    camera->priv->frame_fd[0] = -1;
+    camera->priv->frame_fd[1] = -1;
+    camera->priv->frame_fd_signalled = FALSE;
+
+    g_mutex_init (&camera->priv->dispatch_lock);
+    g_mutex_init (&camera->priv->stats_lock);
+    g_mutex_init (&camera->priv->buffer_mutex);
+    g_cond_init (&camera->priv->buffer_cond);
+    g_mutex_init (&camera->priv->access_lock);
+    g_mutex_init (&camera->priv->state_lock);
+    g_mutex_init (&camera->priv->grab_lock);
+    g_mutex_init (&camera->priv->trigger_lock);
+    g_mutex_init (&camera->priv->snapshot_lock);
+    g_mutex_init (&camera->priv->frame_pool_lock);
+
+    camera->priv->snapshot_valid = FALSE;
+    camera->priv->snapshot_serial = 0;
+    g_signal_connect (camera, "notify", G_CALLBACK (invalidate_snapshot), NULL);
 
     g_value_init (&val, G_TYPE_UINT);
     g_value_set_uint (&val, 1);
@@ -589,6 +978,11 @@ uca_camera_init (UcaCamera *camera)
     uca_camera_set_property_unit (camera_properties[PROP_ROI_WIDTH_MULTIPLIER], UCA_UNIT_PIXEL);
     uca_camera_set_property_unit (camera_properties[PROP_ROI_HEIGHT_MULTIPLIER], UCA_UNIT_PIXEL);
     uca_camera_set_property_unit (camera_properties[PROP_RECORDED_FRAMES], UCA_UNIT_COUNT);
+    uca_camera_set_property_unit (camera_properties[PROP_GRAB_TIMEOUT], UCA_UNIT_SECOND);
+    uca_camera_set_property_unit (camera_properties[PROP_FRAMES_GRABBED], UCA_UNIT_COUNT);
+    uca_camera_set_property_unit (camera_properties[PROP_FRAMES_DROPPED], UCA_UNIT_COUNT);
+    uca_camera_set_property_unit (camera_properties[PROP_FRAMES_OVERRUN], UCA_UNIT_COUNT);
+    uca_camera_set_property_unit (camera_properties[PROP_BYTES_TRANSFERRED], UCA_UNIT_COUNT);
 
 #ifdef WITH_PYTHON_MULTITHREADING
     if (!PyEval_ThreadsInitialized ()) {
@@ -597,597 +991,2938 @@ uca_camera_init (UcaCamera *camera)
 #endif
 }
 
-static gpointer
-buffer_thread (UcaCamera *camera)
+static inline void
+histogram_add (UcaCameraHistogram *histogram, gint64 value)
 {
-    UcaCameraClass *klass;
-    GError *error = NULL;
-
-    klass = UCA_CAMERA_GET_CLASS (camera);
-
-    while (!camera->priv->cancelling_recording) {
-        gpointer buffer;
-
-        buffer = uca_ring_buffer_get_write_pointer (camera->priv->ring_buffer);
+    guint64 sample = (guint64) MAX (value, 0);
+    guint bin = 0;
 
-        if (!(*klass->grab) (camera, buffer, &error))
-            break;
-
-        uca_ring_buffer_write_advance (camera->priv->ring_buffer);
-    }
+    if (sample > 0)
+        bin = MIN (g_bit_storage (sample), UCA_CAMERA_HISTOGRAM_BINS - 1);
 
-    return error;
+    histogram->bins[bin]++;
+    histogram->n_samples++;
+    histogram->sum += sample;
+    histogram->max = MAX (histogram->max, sample);
 }
 
-/**
- * uca_camera_parse_arg_props:
- * @camera: A #UcaCamera object
- * @argv: Array of property assignment strings in the form of `prop=value`
- * @argc: Length of @argv
- * @error: Location to store a #UcaCameraError error or %NULL
- *
- * Parses the assignment array @argv and sets the property to the given value.
- * If an error occures, @error is set and %FALSE is returned.
- *
- * Returns: %TRUE on success.
+/*
+ * The per-frame statistics are written without locks. Each group of fields
+ * has a single writer at a time, the grabbing thread which holds access_lock
+ * or is the buffer thread, and the buffered consumer which holds buffer_mutex.
+ * A group is published with a sequence counter that is odd while an update is
+ * in progress and uca_camera_get_stats() retries until its copy is consistent.
  */
-gboolean
-uca_camera_parse_arg_props (UcaCamera *camera, gchar **argv, guint argc, GError **error)
+static inline void
+stats_write_begin (gint *seq)
 {
-    GRegex *assignment;
+    g_atomic_int_inc (seq);
+}
 
-    assignment = g_regex_new ("\\s*([A-Za-z0-9-]*)=(.*)\\s*", 0, 0, error);
+static inline void
+stats_write_end (gint *seq)
+{
+    g_atomic_int_inc (seq);
+}
 
-    if (*error)
-        return FALSE;
+static void
+stats_read (gint *seq, gpointer dst, gconstpointer src, gsize size)
+{
+    gint start;
 
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UCHAR,   value_transform_uchar);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_INT,     value_transform_int);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UINT,    value_transform_uint);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_UINT64,  value_transform_uint64);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_LONG,    value_transform_long);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_ULONG,   value_transform_ulong);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_FLOAT,   value_transform_float);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_DOUBLE,  value_transform_double);
-    g_value_register_transform_func (G_TYPE_STRING, G_TYPE_BOOLEAN, value_transform_boolean);
+    do {
+        while ((start = g_atomic_int_get (seq)) & 1)
+            g_thread_yield ();
 
-    for (guint i = 0; i < argc; i++) {
-        GMatchInfo *match;
-        gboolean success = TRUE;
+        memcpy (dst, src, size);
+    } while (g_atomic_int_get (seq) != start);
+}
 
-        g_regex_match (assignment, argv[i], 0, &match);
+/*
+ * Lock the camera for grabbing and remember when we started waiting, so that
+ * the next record_frames() can account the wait.
+ */
+static void
+lock_access (UcaCameraPrivate *priv)
+{
+    gint64 start;
 
-        if (g_match_info_matches (match)) {
-            GParamSpec *pspec;
-            GValue value = {0};
+    start = g_get_monotonic_time ();
+    uca_trace_begin ("access_lock");
+    g_mutex_lock (&priv->access_lock);
+    uca_trace_end ("access_lock");
+    priv->access_wait_start = start;
+}
+
+/*
+ * Account @n frames transferred by one call of a grab method.
+ */
+static void
+record_frames (UcaCameraPrivate *priv, guint n, gint64 grab_start, gint64 grab_end, guint64 hw_sequence)
+{
+    stats_write_begin (&priv->stats_seq);
 
-            gchar *prop = g_match_info_fetch (match, 1);
-            gchar *string_value = g_match_info_fetch (match, 2);
+    if (priv->access_wait_start > 0) {
+        histogram_add (&priv->stats.access_wait_time, grab_start - priv->access_wait_start);
+        priv->access_wait_start = 0;
+    }
 
-            g_value_init (&value, G_TYPE_STRING);
-            g_value_set_string (&value, string_value);
+    if (priv->stats.n_grabbed > 0 && hw_sequence > priv->stats_last_hw_sequence)
+        priv->stats.n_dropped += hw_sequence - priv->stats_last_hw_sequence - 1;
 
-            pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (camera), prop);
+    priv->stats_last_hw_sequence = hw_sequence + n - 1;
+    priv->stats.n_grabbed += n;
+    priv->stats.n_bytes += n * priv->stats_frame_size;
+    histogram_add (&priv->stats.grab_time, grab_end - grab_start);
 
-            if (pspec != NULL) {
-                GValue target_value = {0};
+    stats_write_end (&priv->stats_seq);
+}
 
-                g_value_init (&target_value, pspec->value_type);
-                g_value_transform (&value, &target_value);
-                g_object_set_property (G_OBJECT (camera), prop, &target_value);
-            }
-            else {
-                g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
-                             "No property `%s' found", prop);
-                success = FALSE;
-            }
+static void
+reset_stats (UcaCamera *camera)
+{
+    UcaCameraPrivate *priv;
+    UcaFrameFormat format;
 
-            g_match_info_free (match);
-            g_free (prop);
-            g_free (string_value);
+    priv = camera->priv;
 
-            if (!success)
-                return FALSE;
-        }
-    }
+    /* Count the bytes as they come from the camera, i.e. before unpacking */
+    UCA_CAMERA_GET_CLASS (camera)->get_frame_format (camera, &format);
+
+    /* Nothing grabs or consumes frames while recording starts */
+    g_mutex_lock (&priv->stats_lock);
+    stats_write_begin (&priv->stats_seq);
+    stats_write_begin (&priv->consumer_stats_seq);
+    memset (&priv->stats, 0, sizeof (UcaCameraStats));
+    priv->stats_frame_size = format.size;
+    priv->stats_last_hw_sequence = 0;
+    priv->stop_time = 0;
+    stats_write_end (&priv->consumer_stats_seq);
+    stats_write_end (&priv->stats_seq);
+    g_mutex_unlock (&priv->stats_lock);
+}
 
-    g_regex_unref (assignment);
-    return TRUE;
+static void
+forward_cancel (GCancellable *cancellable, GCancellable *target)
+{
+    g_cancellable_cancel (target);
 }
 
-/**
- * uca_camera_start_recording:
- * @camera: A #UcaCamera object
- * @error: Location to store a #UcaCameraError error or %NULL
- *
- * Initiate recording of frames. If UcaCamera:grab-asynchronous is %TRUE and a
- * #UcaCameraGrabFunc callback is set, frames are automatically transfered to
- * the client program, otherwise you must use uca_camera_grab().
+/*
+ * Call the plugin's grab method. Plugins implementing grab_cancellable get a
+ * single cancellable that fires when recording is stopped or when the
+ * caller's @cancellable is cancelled.
  */
-void
-uca_camera_start_recording (UcaCamera *camera, GError **error)
+static gboolean
+call_grab (UcaCamera *camera, UcaCameraClass *klass, gpointer data, GCancellable *cancellable, GError **error)
 {
-    UcaCameraClass *klass;
     UcaCameraPrivate *priv;
-    GError *tmp_error = NULL;
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
-
-    g_return_if_fail (UCA_IS_CAMERA (camera));
+    gulong handler = 0;
+    gboolean result;
 
-    klass = UCA_CAMERA_GET_CLASS (camera);
+    priv = camera->priv;
 
-    g_return_if_fail (klass != NULL);
-    g_return_if_fail (klass->start_recording != NULL);
+    if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return FALSE;
 
-    priv = camera->priv;
+    if (klass->grab_cancellable == NULL)
+        return (*klass->grab) (camera, data, error);
 
-    g_static_mutex_lock (&mutex);
+    if (cancellable != NULL)
+        handler = g_cancellable_connect (cancellable, G_CALLBACK (forward_cancel), priv->grab_cancellable, NULL);
 
-    if (priv->is_recording) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
-                     "Camera is already recording");
-        goto start_recording_unlock;
-    }
+    result = (*klass->grab_cancellable) (camera, data, priv->grab_cancellable, error);
 
-    if (priv->transfer_async && (camera->grab_func == NULL)) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NO_GRAB_FUNC,
-                     "No grab callback function set");
-        goto start_recording_unlock;
-    }
+    if (cancellable != NULL) {
+        g_cancellable_disconnect (cancellable, handler);
 
-    g_static_mutex_lock (&access_lock);
-    (*klass->start_recording)(camera, &tmp_error);
-    g_static_mutex_unlock (&access_lock);
+        /* Re-arm unless stop_recording() cancelled it in the meantime */
+        if (g_cancellable_is_cancelled (cancellable)) {
+            g_mutex_lock (&priv->buffer_mutex);
 
-    if (tmp_error == NULL) {
-        priv->is_readout = FALSE;
-        priv->is_recording = TRUE;
-        priv->cancelling_recording = FALSE;
+            if (!priv->cancelling_recording)
+                g_cancellable_reset (priv->grab_cancellable);
 
-        /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
-        g_object_notify (G_OBJECT (camera), "is-recording");
+            g_mutex_unlock (&priv->buffer_mutex);
+        }
     }
-    else
-        g_propagate_error (error, tmp_error);
-
-    if (priv->buffered) {
-        guint width, height, bitdepth;
-        guint pixel_size;
 
-        g_object_get (camera,
-                      "roi-width", &width,
-                      "roi-height", &height,
-                      "sensor-bitdepth", &bitdepth,
-                      NULL);
+    return result;
+}
 
-        pixel_size = bitdepth <= 8 ? 1 : 2;
-        priv->ring_buffer = uca_ring_buffer_new (width * height * pixel_size,
-                                                         priv->num_buffers);
+static gboolean
+grab_frame (UcaCamera *camera, UcaCameraClass *klass, gpointer data, UcaFrameInfo *info, GCancellable *cancellable, GError **error)
+{
+    UcaCameraPrivate *priv;
+    gboolean result;
 
-        /* Let's read out the frames from another thread */
-        priv->read_thread = g_thread_new ("read-thread", (GThreadFunc) buffer_thread, camera);
+    priv = camera->priv;
+    priv->has_hw_sequence = FALSE;
+
+    uca_trace_begin ("grab");
+    info->grab_start = g_get_monotonic_time ();
+    result = call_grab (camera, klass, data, cancellable, error);
+    info->grab_end = g_get_monotonic_time ();
+    uca_trace_end ("grab");
+
+    if (result) {
+        info->sequence = priv->sequence++;
+        info->hw_sequence = priv->has_hw_sequence ? priv->hw_sequence : info->sequence;
+        info->n_dropped = 0;
+        record_frames (priv, 1, info->grab_start, info->grab_end, info->hw_sequence);
     }
 
-start_recording_unlock:
-    g_static_mutex_unlock (&mutex);
+    return result;
 }
 
-/**
- * uca_camera_stop_recording:
- * @camera: A #UcaCamera object
- * @error: Location to store a #UcaCameraError error or %NULL
- *
- * Stop recording.
+/*
+ * Called for each frame handed to the user. Gaps in the hardware sequence
+ * cover both frames lost by the camera and frames dropped by the ring buffer.
  */
-void
-uca_camera_stop_recording (UcaCamera *camera, GError **error)
+static void
+account_frame (FrameAccount *account, UcaFrameInfo *info)
 {
-    UcaCameraClass *klass;
-    UcaCameraPrivate *priv;
-    GError *tmp_error = NULL;
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
-
-    g_return_if_fail (UCA_IS_CAMERA (camera));
+    if (account->n_delivered > 0 && info->hw_sequence > account->last_hw_sequence)
+        info->n_dropped = (guint) (info->hw_sequence - account->last_hw_sequence - 1);
+    else
+        info->n_dropped = 0;
 
-    klass = UCA_CAMERA_GET_CLASS (camera);
+    account->last_hw_sequence = info->hw_sequence;
+    account->n_delivered++;
+}
 
-    g_return_if_fail (klass != NULL);
-    g_return_if_fail (klass->stop_recording != NULL);
+static void
+reset_sequence (UcaCameraPrivate *priv)
+{
+    priv->sequence = 0;
+    priv->account.last_hw_sequence = 0;
+    priv->account.n_delivered = 0;
+}
 
+/*
+ * Hand a freshly written block to all subscribers. Lossless subscribers pin
+ * it until they release it, latest-only subscribers only see the newest one.
+ * Must be called with buffer_mutex held.
+ */
+static void
+publish_frame (UcaCameraPrivate *priv, gpointer buffer)
+{
+    for (GList *it = priv->subscribers; it != NULL; it = g_list_next (it)) {
+        UcaCameraSubscriber *subscriber = (UcaCameraSubscriber *) it->data;
+
+        if (subscriber->policy == UCA_CAMERA_SUBSCRIBER_LOSSLESS) {
+            uca_ring_buffer_pin_pointer (priv->ring_buffer, buffer);
+            g_queue_push_tail (subscriber->pending, buffer);
+        }
+    }
+
+    priv->latest_block = buffer;
+    priv->latest_sequence = uca_ring_buffer_get_info (priv->ring_buffer, buffer)->sequence;
+}
+
+static void
+reset_subscribers (UcaCameraPrivate *priv)
+{
+    for (GList *it = priv->subscribers; it != NULL; it = g_list_next (it)) {
+        UcaCameraSubscriber *subscriber = (UcaCameraSubscriber *) it->data;
+
+        g_queue_clear (subscriber->pending);
+        subscriber->has_last = FALSE;
+        subscriber->account.n_delivered = 0;
+    }
+
+    priv->latest_block = NULL;
+}
+
+/*
+ * Make the frame fd readable exactly while uca_camera_grab() would not block,
+ * i.e. a frame is buffered or the buffer thread stopped. Must be called with
+ * buffer_mutex held.
+ */
+static void
+update_frame_fd (UcaCameraPrivate *priv)
+{
+    gboolean ready;
+    guint64 value = 1;
+
+    if (priv->frame_fd[0] < 0)
+        return;
+
+    ready = priv->ring_buffer != NULL &&
+            (uca_ring_buffer_available (priv->ring_buffer) || priv->buffer_thread_done);
+
+    if (ready == priv->frame_fd_signalled)
+        return;
+
+    if (ready) {
+        if (write (priv->frame_fd[1], &value, sizeof (value)) != sizeof (value))
+            g_warning ("Could not signal frame fd: %s", g_strerror (errno));
+    }
+    else {
+        /* Both descriptors are non-blocking, read until drained */
+        while (read (priv->frame_fd[0], &value, sizeof (value)) > 0)
+            ;
+    }
+
+    priv->frame_fd_signalled = ready;
+}
+
+/*
+ * Buffered synchronous acquisition can unpack packed frames before they enter
+ * the ring buffer, so every consumer sees 16 bit pixels.
+ */
+static gboolean
+unpacks_frames (UcaCameraPrivate *priv)
+{
+    return priv->buffered && priv->buffer_unpack && !priv->transfer_async;
+}
+
+static gpointer
+buffer_thread (UcaCamera *camera)
+{
+    UcaCameraClass *klass;
+    UcaCameraPrivate *priv;
+    GError *error = NULL;
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
     priv = camera->priv;
 
-    g_static_mutex_lock (&mutex);
+    while (!priv->cancelling_recording) {
+        gpointer buffer;
+        guint fill_level;
 
-    if (!priv->is_recording) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
-                     "Camera is not recording");
-        goto error_stop_recording;
+        /*
+         * With the blocking overrun policy, the ring buffer hands out no block
+         * until the consumer read or released one.
+         */
+        g_mutex_lock (&priv->buffer_mutex);
+
+        while ((buffer = uca_ring_buffer_get_write_pointer (priv->ring_buffer)) == NULL &&
+               !priv->cancelling_recording) {
+            uca_trace_begin ("wait for free block");
+            g_cond_wait (&priv->buffer_cond, &priv->buffer_mutex);
+            uca_trace_end ("wait for free block");
+        }
+
+        g_mutex_unlock (&priv->buffer_mutex);
+
+        if (priv->cancelling_recording)
+            break;
+
+        if (priv->unpack_buffer != NULL) {
+            if (!grab_frame (camera, klass, priv->unpack_buffer, uca_ring_buffer_get_info (priv->ring_buffer, buffer), NULL, &error))
+                break;
+
+            uca_unpack_frame (&priv->unpack_format, priv->unpack_buffer, buffer);
+        }
+        else if (!grab_frame (camera, klass, buffer, uca_ring_buffer_get_info (priv->ring_buffer, buffer), NULL, &error))
+            break;
+
+        g_mutex_lock (&priv->buffer_mutex);
+
+        if (uca_ring_buffer_write_advance (priv->ring_buffer))
+            publish_frame (priv, buffer);
+
+        fill_level = uca_ring_buffer_get_fill_level (priv->ring_buffer);
+        uca_trace_counter ("ring fill level", fill_level);
+
+        stats_write_begin (&priv->stats_seq);
+        histogram_add (&priv->stats.fill_level, fill_level);
+        priv->stats.n_overruns = uca_ring_buffer_get_num_overruns (priv->ring_buffer);
+        stats_write_end (&priv->stats_seq);
+
+        update_frame_fd (priv);
+        g_cond_broadcast (&priv->buffer_cond);
+        g_mutex_unlock (&priv->buffer_mutex);
     }
 
-    priv->cancelling_recording = TRUE;
+    /* A grab interrupted by uca_camera_stop_recording() is no error */
+    if (priv->cancelling_recording)
+        g_clear_error (&error);
 
-    if (priv->buffered) {
-        g_thread_join (priv->read_thread);
-        priv->read_thread = NULL;
+    /* Wake up consumers so they can report the error or end of stream */
+    g_mutex_lock (&priv->buffer_mutex);
+    priv->buffer_error = error;
+    priv->buffer_thread_done = TRUE;
+    update_frame_fd (priv);
+    g_cond_broadcast (&priv->buffer_cond);
+    g_mutex_unlock (&priv->buffer_mutex);
+
+    return NULL;
+}
+
+/**
+ * uca_camera_parse_arg_props:
+ * @camera: A #UcaCamera object
+ * @argv: Array of property assignment strings in the form of `prop=value`
+ * @argc: Length of @argv
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Parses the assignment array @argv and sets the properties to the given
+ * values in one transaction with uca_camera_set_properties_batch(). If an
+ * error occures, @error is set, no property is changed and %FALSE is returned.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+uca_camera_parse_arg_props (UcaCamera *camera, gchar **argv, guint argc, GError **error)
+{
+    GRegex *assignment;
+    gchar **names;
+    GValue *values;
+    guint n_properties = 0;
+    gboolean result;
+
+    assignment = g_regex_new ("\\s*([A-Za-z0-9-]*)=(.*)\\s*", 0, 0, error);
+
+    if (assignment == NULL)
+        return FALSE;
+
+    names = g_new0 (gchar *, argc + 1);
+    values = g_new0 (GValue, argc);
+
+    for (guint i = 0; i < argc; i++) {
+        GMatchInfo *match;
+
+        g_regex_match (assignment, argv[i], 0, &match);
+
+        if (g_match_info_matches (match)) {
+            names[n_properties] = g_match_info_fetch (match, 1);
+            g_value_init (&values[n_properties], G_TYPE_STRING);
+            g_value_take_string (&values[n_properties], g_match_info_fetch (match, 2));
+            n_properties++;
+        }
+
+        g_match_info_free (match);
     }
 
-    g_static_mutex_lock (&access_lock);
+    result = uca_camera_set_properties_batch (camera, n_properties, (const gchar **) names, values, error);
 
-    (*klass->stop_recording)(camera, &tmp_error);
-    priv->cancelling_recording = FALSE;
+    for (guint i = 0; i < n_properties; i++)
+        g_value_unset (&values[i]);
 
-    g_static_mutex_unlock (&access_lock);
+    g_free (values);
+    g_strfreev (names);
+    g_regex_unref (assignment);
+    return result;
+}
 
-    if (tmp_error == NULL) {
-        priv->is_recording = FALSE;
-        priv->is_readout = FALSE;
-        /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
-        g_object_notify (G_OBJECT (camera), "is-recording");
+static GParamSpec *
+validate_property (UcaCamera *camera, const gchar *name, const GValue *value, GValue *converted, GError **error)
+{
+    GParamSpec *pspec;
+
+    pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (camera), name);
+
+    if (pspec == NULL) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
+                     "No property `%s' found", name);
+        return NULL;
     }
-    else
-        g_propagate_error (error, tmp_error);
 
-    if (camera->priv->ring_buffer != NULL) {
-        g_object_unref (camera->priv->ring_buffer);
-        camera->priv->ring_buffer = NULL;
+    if (!(pspec->flags & G_PARAM_WRITABLE) || (pspec->flags & G_PARAM_CONSTRUCT_ONLY)) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_INVALID_VALUE,
+                     "Property `%s' is not writable", name);
+        return NULL;
     }
 
-error_stop_recording:
-    g_static_mutex_unlock (&mutex);
+    if (camera->priv->is_recording && !g_param_spec_get_qdata (pspec, UCA_WRITABLE_QUARK)) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Property `%s' cannot be written during acquisition", name);
+        return NULL;
+    }
+
+    g_value_init (converted, pspec->value_type);
+
+    if (!g_value_transform (value, converted)) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_INVALID_VALUE,
+                     "Cannot convert %s to %s for property `%s'",
+                     G_VALUE_TYPE_NAME (value), g_type_name (pspec->value_type), name);
+        return NULL;
+    }
+
+    /* Validation clamps the value, so any modification means out of range */
+    if (g_param_value_validate (pspec, converted)) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_INVALID_VALUE,
+                     "Value for property `%s' is out of range", name);
+        return NULL;
+    }
+
+    return pspec;
 }
 
 /**
- * uca_camera_is_recording:
+ * uca_camera_set_properties_batch:
  * @camera: A #UcaCamera object
+ * @n_properties: Number of properties to set
+ * @names: (array length=n_properties): Names of the properties
+ * @values: (array length=n_properties): Values of the properties, which are
+ *  converted to the property types if necessary
+ * @error: Location to store a #UcaCameraError error or %NULL
  *
- * Convenience function to ask the current recording status
+ * Set several properties at once. All values are converted and validated
+ * first, so that on error no property is changed. Cameras that implement
+ * #UcaCameraClass.set_properties() receive all values in a single call and
+ * can program the hardware once, other cameras get them one by one. In both
+ * cases ::notify is emitted once per property after all values have been
+ * applied.
  *
- * Return value: %TRUE if recording is ongoing
- * Since: 1.5
+ * Returns: %TRUE if all properties were set.
+ * Since: 2.3
  */
 gboolean
-uca_camera_is_recording (UcaCamera *camera)
+uca_camera_set_properties_batch (UcaCamera *camera,
+                                 guint n_properties,
+                                 const gchar **names,
+                                 const GValue *values,
+                                 GError **error)
 {
+    UcaCameraClass *klass;
+    GParamSpec **pspecs;
+    GValue *converted;
+    gboolean result = TRUE;
+
     g_return_val_if_fail (UCA_IS_CAMERA (camera), FALSE);
-    return camera->priv->is_recording;
+    g_return_val_if_fail ((names != NULL && values != NULL) || n_properties == 0, FALSE);
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+    pspecs = g_new0 (GParamSpec *, n_properties);
+    converted = g_new0 (GValue, n_properties);
+
+    for (guint i = 0; i < n_properties && result; i++) {
+        pspecs[i] = validate_property (camera, names[i], &values[i], &converted[i], error);
+        result = pspecs[i] != NULL;
+    }
+
+    if (result) {
+        g_object_freeze_notify (G_OBJECT (camera));
+
+        if (klass->set_properties != NULL) {
+            result = klass->set_properties (camera, n_properties, pspecs, converted, error);
+
+            for (guint i = 0; i < n_properties && result; i++)
+                g_object_notify (G_OBJECT (camera), pspecs[i]->name);
+        }
+        else {
+            for (guint i = 0; i < n_properties; i++)
+                g_object_set_property (G_OBJECT (camera), pspecs[i]->name, &converted[i]);
+        }
+
+        g_object_thaw_notify (G_OBJECT (camera));
+    }
+
+    for (guint i = 0; i < n_properties; i++) {
+        if (G_IS_VALUE (&converted[i]))
+            g_value_unset (&converted[i]);
+    }
+
+    g_free (converted);
+    g_free (pspecs);
+    return result;
+}
+
+static void
+dispatch_worker (DispatchSlot *slot, UcaCamera *camera)
+{
+    UcaCameraPrivate *priv;
+    UcaCameraDispatchStats *stats;
+    gint64 start;
+    gint64 end;
+    gdouble latency;
+    gdouble callback_time;
+
+    priv = camera->priv;
+    start = g_get_monotonic_time ();
+    priv->dispatch_func (slot->data, priv->dispatch_user_data);
+    end = g_get_monotonic_time ();
+
+    latency = (gdouble) (end - slot->enqueue_time) / G_TIME_SPAN_SECOND;
+    callback_time = (gdouble) (end - start) / G_TIME_SPAN_SECOND;
+
+    g_mutex_lock (&priv->dispatch_lock);
+    stats = &priv->dispatch_stats;
+    stats->n_dispatched++;
+    stats->queue_depth--;
+    stats->mean_latency += (latency - stats->mean_latency) / stats->n_dispatched;
+    stats->mean_callback_time += (callback_time - stats->mean_callback_time) / stats->n_dispatched;
+    stats->max_latency = MAX (stats->max_latency, latency);
+    stats->max_callback_time = MAX (stats->max_callback_time, callback_time);
+    g_mutex_unlock (&priv->dispatch_lock);
+
+    g_async_queue_push (priv->dispatch_free, slot);
+}
+
+/*
+ * Installed as the grab callback while dispatching is enabled. It runs on the
+ * acquisition thread, so it only copies the frame into a free slot and never
+ * waits for one.
+ */
+static void
+dispatch_grab_func (gpointer data, gpointer user_data)
+{
+    UcaCamera *camera;
+    UcaCameraPrivate *priv;
+    DispatchSlot *slot;
+
+    camera = UCA_CAMERA (user_data);
+    priv = camera->priv;
+    slot = g_async_queue_try_pop (priv->dispatch_free);
+
+    g_mutex_lock (&priv->dispatch_lock);
+
+    if (slot == NULL) {
+        priv->dispatch_stats.n_dropped++;
+    }
+    else {
+        priv->dispatch_stats.queue_depth++;
+        priv->dispatch_stats.max_queue_depth = MAX (priv->dispatch_stats.max_queue_depth,
+                                                    priv->dispatch_stats.queue_depth);
+    }
+
+    g_mutex_unlock (&priv->dispatch_lock);
+
+    if (slot == NULL)
+        return;
+
+    memcpy (slot->data, data, priv->dispatch_frame_size);
+    slot->enqueue_time = g_get_monotonic_time ();
+    g_thread_pool_push (priv->dispatch_pool, slot, NULL);
+}
+
+static gboolean
+start_dispatch (UcaCamera *camera, GError **error)
+{
+    UcaCameraPrivate *priv;
+    guint n_threads;
+
+    priv = camera->priv;
+
+    /* A single worker runs a FIFO pool strictly in submission order */
+    n_threads = priv->dispatch_ordered ? 1 : priv->dispatch_threads;
+    priv->dispatch_pool = g_thread_pool_new ((GFunc) dispatch_worker, camera,
+                                             n_threads, TRUE, error);
+
+    if (priv->dispatch_pool == NULL)
+        return FALSE;
+
+    priv->dispatch_frame_size = uca_camera_get_frame_size (camera);
+    priv->dispatch_free = g_async_queue_new ();
+    priv->dispatch_slots = g_new0 (DispatchSlot, priv->dispatch_queue_length);
+
+    for (guint i = 0; i < priv->dispatch_queue_length; i++) {
+        priv->dispatch_slots[i].data = g_malloc0 (priv->dispatch_frame_size);
+        g_async_queue_push (priv->dispatch_free, &priv->dispatch_slots[i]);
+    }
+
+    memset (&priv->dispatch_stats, 0, sizeof (UcaCameraDispatchStats));
+    priv->dispatch_func = camera->grab_func;
+    priv->dispatch_user_data = camera->user_data;
+    camera->grab_func = dispatch_grab_func;
+    camera->user_data = camera;
+
+    return TRUE;
+}
+
+static void
+stop_dispatch (UcaCamera *camera)
+{
+    UcaCameraPrivate *priv;
+
+    priv = camera->priv;
+
+    if (priv->dispatch_pool == NULL)
+        return;
+
+    /* Run all frames that are still queued before tearing down */
+    g_thread_pool_free (priv->dispatch_pool, FALSE, TRUE);
+    priv->dispatch_pool = NULL;
+
+    camera->grab_func = priv->dispatch_func;
+    camera->user_data = priv->dispatch_user_data;
+
+    for (guint i = 0; i < priv->dispatch_queue_length; i++)
+        g_free (priv->dispatch_slots[i].data);
+
+    g_free (priv->dispatch_slots);
+    g_async_queue_unref (priv->dispatch_free);
+    priv->dispatch_slots = NULL;
+    priv->dispatch_free = NULL;
 }
 
 /**
- * uca_camera_start_readout:
+ * uca_camera_start_recording:
  * @camera: A #UcaCamera object
  * @error: Location to store a #UcaCameraError error or %NULL
  *
- * Initiate readout mode for cameras that support
- * #UcaCamera:has-camram-recording after calling
- * uca_camera_stop_recording(). Frames have to be picked up with
- * ufo_camera_grab().
+ * Initiate recording of frames. If UcaCamera:grab-asynchronous is %TRUE and a
+ * #UcaCameraGrabFunc callback is set, frames are automatically transfered to
+ * the client program, otherwise you must use uca_camera_grab().
  */
 void
-uca_camera_start_readout (UcaCamera *camera, GError **error)
+uca_camera_start_recording (UcaCamera *camera, GError **error)
 {
     UcaCameraClass *klass;
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
+    UcaCameraPrivate *priv;
+    GError *tmp_error = NULL;
 
-    g_return_if_fail (UCA_IS_CAMERA(camera));
+    g_return_if_fail (UCA_IS_CAMERA (camera));
 
-    klass = UCA_CAMERA_GET_CLASS(camera);
+    klass = UCA_CAMERA_GET_CLASS (camera);
 
     g_return_if_fail (klass != NULL);
-    g_return_if_fail (klass->start_readout != NULL);
+    g_return_if_fail (klass->start_recording != NULL);
+
+    priv = camera->priv;
+
+    g_mutex_lock (&priv->state_lock);
+
+    if (priv->is_recording) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Camera is already recording");
+        goto start_recording_unlock;
+    }
 
-    g_static_mutex_lock (&mutex);
+    if (priv->transfer_async && (camera->grab_func == NULL)) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NO_GRAB_FUNC,
+                     "No grab callback function set");
+        goto start_recording_unlock;
+    }
+
+    if (priv->buffered && priv->subscribers != NULL && priv->num_buffers < 2) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Subscribers require at least two buffers");
+        goto start_recording_unlock;
+    }
+
+    if (priv->transfer_async && priv->dispatch_threads > 0) {
+        if (!start_dispatch (camera, error))
+            goto start_recording_unlock;
+    }
+
+    g_cancellable_reset (priv->grab_cancellable);
+
+    g_mutex_lock (&priv->access_lock);
+    uca_trace_begin ("start_recording");
+    (*klass->start_recording)(camera, &tmp_error);
+    uca_trace_end ("start_recording");
+    g_mutex_unlock (&priv->access_lock);
+
+    if (tmp_error == NULL) {
+        priv->is_readout = FALSE;
+        priv->is_recording = TRUE;
+        priv->cancelling_recording = FALSE;
+        reset_sequence (priv);
+        reset_stats (camera);
+
+        /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
+        g_object_notify (G_OBJECT (camera), "is-recording");
+    }
+    else {
+        stop_dispatch (camera);
+        g_propagate_error (error, tmp_error);
+        goto start_recording_unlock;
+    }
+
+    if (priv->buffered) {
+        if (unpacks_frames (priv)) {
+            klass->get_frame_format (camera, &priv->unpack_format);
+
+            if (uca_pixel_format_is_packed (priv->unpack_format.pixel_format))
+                priv->unpack_buffer = g_malloc (priv->unpack_format.size);
+        }
+
+        priv->ring_buffer = uca_ring_buffer_new_full (uca_camera_get_frame_size (camera),
+                                                      priv->num_buffers,
+                                                      priv->buffer_alloc_flags,
+                                                      priv->buffer_numa_node);
+        uca_ring_buffer_set_overrun_policy (priv->ring_buffer, priv->overrun_policy);
+
+        priv->buffer_error = NULL;
+        priv->buffer_thread_done = FALSE;
+
+        g_mutex_lock (&priv->buffer_mutex);
+        reset_subscribers (priv);
+        update_frame_fd (priv);
+        g_mutex_unlock (&priv->buffer_mutex);
+
+        /* Let's read out the frames from another thread */
+        priv->read_thread = g_thread_new ("read-thread", (GThreadFunc) buffer_thread, camera);
+    }
+
+start_recording_unlock:
+    g_mutex_unlock (&priv->state_lock);
+}
+
+/**
+ * uca_camera_stop_recording:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Stop recording.
+ */
+void
+uca_camera_stop_recording (UcaCamera *camera, GError **error)
+{
+    UcaCameraClass *klass;
+    UcaCameraPrivate *priv;
+    GError *tmp_error = NULL;
+    gint64 stop_start;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_if_fail (klass != NULL);
+    g_return_if_fail (klass->stop_recording != NULL);
+
+    priv = camera->priv;
+
+    g_mutex_lock (&priv->state_lock);
+
+    if (!priv->is_recording) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera is not recording");
+        goto error_stop_recording;
+    }
+
+    stop_start = g_get_monotonic_time ();
+
+    /* Interrupt plugins blocked in grab_cancellable, e.g. waiting for a trigger */
+    g_mutex_lock (&priv->buffer_mutex);
+    priv->cancelling_recording = TRUE;
+    g_cancellable_cancel (priv->grab_cancellable);
+    g_cond_broadcast (&priv->buffer_cond);
+    g_mutex_unlock (&priv->buffer_mutex);
+
+    if (priv->buffered) {
+        g_thread_join (priv->read_thread);
+        priv->read_thread = NULL;
+        g_clear_error (&priv->buffer_error);
+
+        /* Pending frames refer to the ring buffer which is going away */
+        g_mutex_lock (&priv->buffer_mutex);
+        reset_subscribers (priv);
+        g_mutex_unlock (&priv->buffer_mutex);
+    }
+
+    g_mutex_lock (&priv->access_lock);
+
+    uca_trace_begin ("stop_recording");
+    (*klass->stop_recording)(camera, &tmp_error);
+    uca_trace_end ("stop_recording");
+    priv->cancelling_recording = FALSE;
+
+    g_mutex_unlock (&priv->access_lock);
+
+    stop_dispatch (camera);
+
+    if (tmp_error == NULL) {
+        priv->is_recording = FALSE;
+        priv->is_readout = FALSE;
+        /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
+        g_object_notify (G_OBJECT (camera), "is-recording");
+    }
+    else
+        g_propagate_error (error, tmp_error);
+
+    if (camera->priv->ring_buffer != NULL) {
+        g_mutex_lock (&priv->buffer_mutex);
+        g_object_unref (camera->priv->ring_buffer);
+        camera->priv->ring_buffer = NULL;
+        update_frame_fd (priv);
+        g_mutex_unlock (&priv->buffer_mutex);
+    }
+
+    g_free (priv->unpack_buffer);
+    priv->unpack_buffer = NULL;
+
+    /* Not part of a sequence group, a grab may still race with stopping */
+    g_mutex_lock (&priv->stats_lock);
+    priv->stop_time = (guint64) (g_get_monotonic_time () - stop_start);
+    g_mutex_unlock (&priv->stats_lock);
+
+error_stop_recording:
+    g_mutex_unlock (&priv->state_lock);
+}
+
+/**
+ * uca_camera_is_recording:
+ * @camera: A #UcaCamera object
+ *
+ * Convenience function to ask the current recording status
+ *
+ * Return value: %TRUE if recording is ongoing
+ * Since: 1.5
+ */
+gboolean
+uca_camera_is_recording (UcaCamera *camera)
+{
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), FALSE);
+    return camera->priv->is_recording;
+}
+
+/**
+ * uca_camera_start_readout:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Initiate readout mode for cameras that support
+ * #UcaCamera:has-camram-recording after calling
+ * uca_camera_stop_recording(). Frames have to be picked up with
+ * ufo_camera_grab().
+ */
+void
+uca_camera_start_readout (UcaCamera *camera, GError **error)
+{
+    UcaCameraClass *klass;
+
+    g_return_if_fail (UCA_IS_CAMERA(camera));
+
+    klass = UCA_CAMERA_GET_CLASS(camera);
+
+    g_return_if_fail (klass != NULL);
+    g_return_if_fail (klass->start_readout != NULL);
+
+    g_mutex_lock (&camera->priv->state_lock);
+
+    if (camera->priv->is_recording) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Camera is still recording");
+    }
+    else {
+        GError *tmp_error = NULL;
+
+        g_cancellable_reset (camera->priv->grab_cancellable);
+
+        g_mutex_lock (&camera->priv->access_lock);
+        uca_trace_begin ("start_readout");
+        (*klass->start_readout) (camera, &tmp_error);
+        uca_trace_end ("start_readout");
+        g_mutex_unlock (&camera->priv->access_lock);
+
+        if (tmp_error == NULL) {
+            camera->priv->is_readout = TRUE;
+            reset_sequence (camera->priv);
+            reset_stats (camera);
+            /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
+            g_object_notify (G_OBJECT (camera), "is-readout");
+        }
+        else
+            g_propagate_error (error, tmp_error);
+    }
+
+    g_mutex_unlock (&camera->priv->state_lock);
+}
+
+/**
+ * uca_camera_stop_readout:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Stop reading out frames.
+ *
+ * Since: 1.1
+ */
+void
+uca_camera_stop_readout (UcaCamera *camera, GError **error)
+{
+    UcaCameraClass *klass;
+
+    g_return_if_fail (UCA_IS_CAMERA(camera));
+
+    klass = UCA_CAMERA_GET_CLASS(camera);
+
+    g_return_if_fail (klass != NULL);
+    g_return_if_fail (klass->stop_readout != NULL);
+
+    g_mutex_lock (&camera->priv->state_lock);
+
+    if (camera->priv->is_recording) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Camera is still recording");
+    }
+    else {
+        GError *tmp_error = NULL;
+
+        g_mutex_lock (&camera->priv->access_lock);
+        uca_trace_begin ("stop_readout");
+        (*klass->stop_readout) (camera, &tmp_error);
+        uca_trace_end ("stop_readout");
+        g_mutex_unlock (&camera->priv->access_lock);
+
+        if (tmp_error == NULL) {
+            camera->priv->is_readout = FALSE;
+            g_object_notify (G_OBJECT (camera), "is-readout");
+        }
+        else
+            g_propagate_error (error, tmp_error);
+    }
+
+    g_mutex_unlock (&camera->priv->state_lock);
+}
+
+/**
+ * uca_camera_set_grab_func:
+ * @camera: A #UcaCamera object
+ * @func: (scope call): A #UcaCameraGrabFunc callback function
+ * @user_data: (closure): Data that is passed on to #func
+ *
+ * Set the grab function that is called whenever a frame is readily transfered.
+ */
+void
+uca_camera_set_grab_func(UcaCamera *camera, UcaCameraGrabFunc func, gpointer user_data)
+{
+    if (camera->priv->dispatch_pool != NULL) {
+        camera->priv->dispatch_func = func;
+        camera->priv->dispatch_user_data = user_data;
+        return;
+    }
+
+    camera->grab_func = func;
+    camera->user_data = user_data;
+}
+
+/**
+ * uca_camera_get_dispatch_stats:
+ * @camera: A #UcaCamera object
+ * @stats: (out caller-allocates): Location to store the statistics
+ *
+ * Get statistics of the dispatch queue that runs grab callbacks when
+ * #UcaCamera:dispatch-threads is non-zero. They are reset each time recording
+ * starts and remain available after it stopped. Use them to size
+ * #UcaCamera:dispatch-threads and #UcaCamera:dispatch-queue-length.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_get_dispatch_stats (UcaCamera *camera, UcaCameraDispatchStats *stats)
+{
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (stats != NULL);
+
+    g_mutex_lock (&camera->priv->dispatch_lock);
+    *stats = camera->priv->dispatch_stats;
+    g_mutex_unlock (&camera->priv->dispatch_lock);
+}
+
+/**
+ * uca_camera_get_stats:
+ * @camera: A #UcaCamera object
+ * @stats: (out caller-allocates): Location to store the statistics
+ *
+ * Get a consistent snapshot of the acquisition statistics. They are reset
+ * each time recording or readout starts and remain available after it
+ * stopped. The counters are also exposed as #UcaCamera:frames-grabbed,
+ * #UcaCamera:frames-dropped, #UcaCamera:frames-overrun and
+ * #UcaCamera:bytes-transferred.
+ *
+ * Recording costs a few clock reads and atomic increments per frame, so the
+ * statistics are always enabled. Reading them never blocks the acquisition.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_get_stats (UcaCamera *camera, UcaCameraStats *stats)
+{
+    UcaCameraPrivate *priv;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (stats != NULL);
+
+    priv = camera->priv;
+    stats_read (&priv->stats_seq, stats, &priv->stats, sizeof (UcaCameraStats));
+    stats_read (&priv->consumer_stats_seq, &stats->consumer_wait_time,
+                &priv->stats.consumer_wait_time, sizeof (UcaCameraHistogram));
+
+    g_mutex_lock (&priv->stats_lock);
+    stats->stop_time = priv->stop_time;
+    g_mutex_unlock (&priv->stats_lock);
+}
+
+/**
+ * uca_camera_trigger:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Trigger from software if supported by camera.
+ *
+ * You must have called uca_camera_start_recording() before, otherwise you will
+ * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ */
+void
+uca_camera_trigger (UcaCamera *camera, GError **error)
+{
+    UcaCameraClass *klass;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_if_fail (klass != NULL);
+    g_return_if_fail (klass->trigger != NULL);
+
+    g_mutex_lock (&camera->priv->trigger_lock);
+
+    if (!camera->priv->is_recording)
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING, "Camera is not recording");
+    else {
+        uca_trace_begin ("trigger");
+        (*klass->trigger) (camera, error);
+        uca_trace_end ("trigger");
+    }
+
+    g_mutex_unlock (&camera->priv->trigger_lock);
+}
+
+/**
+ * uca_camera_write:
+ * @camera: A #UcaCamera object
+ * @name: String that identifies the written data.
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @size: Size of the data buffer in bytes.
+ * @error: Location to store a #UcaCameraError or %NULL.
+ *
+ * Writes camera-specific @data containing @size bytes and identified by @name.
+ */
+void
+uca_camera_write (UcaCamera *camera, const gchar *name, gpointer data, gsize size, GError **error)
+{
+    UcaCameraClass *klass;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_if_fail (klass != NULL);
+
+    if (klass->write == NULL) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
+                     "`%s' does not provide a `write' method",
+                     G_OBJECT_TYPE_NAME (G_OBJECT (camera)));
+    }
+    else {
+        uca_trace_begin ("write");
+        (*klass->write) (camera, name, data, size, error);
+        uca_trace_end ("write");
+    }
+}
+
+static gboolean
+frame_ready (UcaCameraPrivate *priv, UcaCameraSubscriber *subscriber)
+{
+    if (subscriber == NULL)
+        return uca_ring_buffer_available (priv->ring_buffer);
+
+    if (subscriber->policy == UCA_CAMERA_SUBSCRIBER_LOSSLESS)
+        return !g_queue_is_empty (subscriber->pending);
+
+    return priv->latest_block != NULL &&
+           (!subscriber->has_last || priv->latest_sequence > subscriber->last_sequence);
+}
+
+static gboolean
+wait_for_buffered_frame (UcaCameraPrivate *priv, UcaCameraSubscriber *subscriber, GCancellable *cancellable, GError **error)
+{
+    gint64 end_time = 0;
+
+    if (priv->grab_timeout > 0.0)
+        end_time = g_get_monotonic_time () + (gint64) (priv->grab_timeout * G_TIME_SPAN_SECOND);
+
+    while (!frame_ready (priv, subscriber)) {
+        if (g_cancellable_set_error_if_cancelled (cancellable, error))
+            return FALSE;
+
+        if (priv->buffer_error != NULL) {
+            g_propagate_error (error, g_error_copy (priv->buffer_error));
+            return FALSE;
+        }
+
+        if (priv->buffer_thread_done || priv->cancelling_recording) {
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
+                         "Buffer thread stopped and ring buffer is empty");
+            return FALSE;
+        }
+
+        if (end_time == 0) {
+            g_cond_wait (&priv->buffer_cond, &priv->buffer_mutex);
+        }
+        else if (!g_cond_wait_until (&priv->buffer_cond, &priv->buffer_mutex, end_time)) {
+            if (frame_ready (priv, subscriber))
+                break;
+
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_TIMEOUT,
+                         "Timeout after %.3f s waiting for a buffered frame",
+                         priv->grab_timeout);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+ * Borrow the next frame for @subscriber or, if it is %NULL, from the ring
+ * buffer's own read cursor used by uca_camera_grab().
+ */
+static gpointer
+take_buffered_frame (UcaCameraPrivate *priv, UcaCameraSubscriber *subscriber, UcaFrameInfo *info, GCancellable *cancellable, GError **error)
+{
+    FrameAccount *account = &priv->account;
+    gpointer buffer = NULL;
+    gint64 wait_start = 0;
+    gboolean ready;
+
+    g_mutex_lock (&priv->buffer_mutex);
+
+    /* Only ask the clock if we actually have to wait */
+    if (!frame_ready (priv, subscriber)) {
+        wait_start = g_get_monotonic_time ();
+        uca_trace_begin ("wait for frame");
+    }
+
+    ready = wait_for_buffered_frame (priv, subscriber, cancellable, error);
+
+    if (wait_start > 0)
+        uca_trace_end ("wait for frame");
+
+    if (ready) {
+        stats_write_begin (&priv->consumer_stats_seq);
+        histogram_add (&priv->stats.consumer_wait_time, wait_start > 0 ? g_get_monotonic_time () - wait_start : 0);
+        stats_write_end (&priv->consumer_stats_seq);
+
+        if (subscriber == NULL) {
+            buffer = uca_ring_buffer_borrow_read_pointer (priv->ring_buffer);
+        }
+        else if (subscriber->policy == UCA_CAMERA_SUBSCRIBER_LOSSLESS) {
+            /* Already pinned by publish_frame() */
+            buffer = g_queue_pop_head (subscriber->pending);
+            account = &subscriber->account;
+        }
+        else {
+            buffer = priv->latest_block;
+            uca_ring_buffer_pin_pointer (priv->ring_buffer, buffer);
+            subscriber->last_sequence = priv->latest_sequence;
+            subscriber->has_last = TRUE;
+            account = &subscriber->account;
+        }
+
+        g_cond_broadcast (&priv->buffer_cond);
+
+        if (buffer == NULL) {
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
+                         "Ring buffer is empty");
+        }
+        else {
+            UcaFrameInfo frame_info;
+
+            /* The block's record is shared among readers, account on a copy */
+            frame_info = *uca_ring_buffer_get_info (priv->ring_buffer, buffer);
+            account_frame (account, &frame_info);
+
+            if (info != NULL)
+                *info = frame_info;
+        }
+
+        update_frame_fd (priv);
+    }
+
+    g_mutex_unlock (&priv->buffer_mutex);
+
+    return buffer;
+}
+
+static void
+wake_buffer_waiters (GCancellable *cancellable, UcaCameraPrivate *priv)
+{
+    g_mutex_lock (&priv->buffer_mutex);
+    g_cond_broadcast (&priv->buffer_cond);
+    g_mutex_unlock (&priv->buffer_mutex);
+}
+
+static gpointer
+borrow_buffered_frame (UcaCamera *camera, UcaCameraSubscriber *subscriber, UcaFrameInfo *info, GCancellable *cancellable, GError **error)
+{
+    UcaCameraPrivate *priv;
+    gpointer buffer;
+    gulong handler = 0;
+
+    priv = camera->priv;
+
+    if (priv->ring_buffer == NULL) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera is not recording");
+        return NULL;
+    }
+
+    if (cancellable != NULL)
+        handler = g_cancellable_connect (cancellable, G_CALLBACK (wake_buffer_waiters), priv, NULL);
+
+    /*
+     * Sleep until buffer_thread signals a new frame, fails or stops. The GIL
+     * is released so that other Python threads can run in the meantime.
+     */
+#ifdef WITH_PYTHON_MULTITHREADING
+    if (Py_IsInitialized ()) {
+        PyGILState_STATE state = PyGILState_Ensure ();
+        Py_BEGIN_ALLOW_THREADS
+
+        buffer = take_buffered_frame (priv, subscriber, info, cancellable, error);
+
+        Py_END_ALLOW_THREADS
+        PyGILState_Release (state);
+    }
+    else {
+        buffer = take_buffered_frame (priv, subscriber, info, cancellable, error);
+    }
+#else
+    buffer = take_buffered_frame (priv, subscriber, info, cancellable, error);
+#endif
+
+    if (cancellable != NULL)
+        g_cancellable_disconnect (cancellable, handler);
+
+    return buffer;
+}
+
+/**
+ * uca_camera_grab:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a frame a single frame and store the result in @data.
+ *
+ * You must have called uca_camera_start_recording() before, otherwise you will
+ * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ */
+gboolean
+uca_camera_grab (UcaCamera *camera, gpointer data, GError **error)
+{
+    return uca_camera_grab_with_info (camera, data, NULL, error);
+}
+
+/**
+ * uca_camera_grab_with_info:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a single frame like uca_camera_grab() and additionally store its
+ * sequence number, acquisition time stamps and the number of frames lost
+ * since the previous frame in @info.
+ *
+ * Returns: %TRUE on success.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_grab_with_info (UcaCamera *camera, gpointer data, UcaFrameInfo *info, GError **error)
+{
+    return uca_camera_grab_full (camera, data, info, NULL, error);
+}
+
+/**
+ * uca_camera_grab_full:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
+ * @cancellable: (allow-none): A #GCancellable or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a single frame like uca_camera_grab_with_info(). If @cancellable is
+ * cancelled from another thread, waiting for a buffered frame stops right
+ * away and cameras that implement #UcaCameraClass.grab_cancellable() abort
+ * the transfer. In both cases %FALSE is returned with a
+ * %G_IO_ERROR_CANCELLED error.
+ *
+ * Returns: %TRUE on success.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_grab_full (UcaCamera *camera, gpointer data, UcaFrameInfo *info, GCancellable *cancellable, GError **error)
+{
+    UcaCameraClass *klass;
+    UcaFrameInfo frame_info;
+    gboolean result = FALSE;
+
+    g_return_val_if_fail (UCA_IS_CAMERA(camera), FALSE);
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_val_if_fail (klass != NULL, FALSE);
+    g_return_val_if_fail (klass->grab != NULL, FALSE);
+    g_return_val_if_fail (data != NULL, FALSE);
+
+    uca_trace_begin ("uca_camera_grab");
+
+    if (!camera->priv->buffered) {
+        g_mutex_lock (&camera->priv->grab_lock);
+
+        if (!camera->priv->is_recording && !camera->priv->is_readout) {
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                         "Camera is neither recording nor in readout mode");
+        }
+        else {
+#ifdef WITH_PYTHON_MULTITHREADING
+            if (Py_IsInitialized ()) {
+                PyGILState_STATE state = PyGILState_Ensure ();
+                Py_BEGIN_ALLOW_THREADS
+
+                lock_access (camera->priv);
+                result = grab_frame (camera, klass, data, &frame_info, cancellable, error);
+                g_mutex_unlock (&camera->priv->access_lock);
+
+                Py_END_ALLOW_THREADS
+                PyGILState_Release (state);
+            }
+            else {
+                lock_access (camera->priv);
+                result = grab_frame (camera, klass, data, &frame_info, cancellable, error);
+                g_mutex_unlock (&camera->priv->access_lock);
+            }
+#else
+            lock_access (camera->priv);
+            result = grab_frame (camera, klass, data, &frame_info, cancellable, error);
+            g_mutex_unlock (&camera->priv->access_lock);
+#endif
+
+            if (result) {
+                account_frame (&camera->priv->account, &frame_info);
+
+                if (info != NULL)
+                    *info = frame_info;
+            }
+        }
+
+        g_mutex_unlock (&camera->priv->grab_lock);
+    }
+    else {
+        gpointer buffer;
+
+        buffer = borrow_buffered_frame (camera, NULL, info, cancellable, error);
+
+        if (buffer != NULL) {
+            memcpy (data, buffer, uca_ring_buffer_get_block_size (camera->priv->ring_buffer));
+            uca_camera_frame_release (camera, buffer);
+            result = TRUE;
+        }
+    }
+
+    uca_trace_end ("uca_camera_grab");
+    return result;
+}
+
+/**
+ * uca_camera_grab_frame:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a single frame like uca_camera_grab_with_info() into a #UcaFrame
+ * taken from a pool owned by @camera. The pool holds #UcaCamera:num-buffers
+ * frames initially and grows if more are in use at the same time. Once the
+ * last reference is dropped, the frame is reused by a later call, so no
+ * memory is allocated for each frame. The pool is replaced when the frame
+ * size changes.
+ *
+ * Returns: (transfer full): A #UcaFrame or %NULL on error.
+ * Since: 2.3
+ */
+UcaFrame *
+uca_camera_grab_frame (UcaCamera *camera, GError **error)
+{
+    UcaCameraPrivate *priv;
+    UcaFrame *frame;
+    gsize size;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), NULL);
+
+    priv = camera->priv;
+    size = uca_camera_get_frame_size (camera);
+
+    g_mutex_lock (&priv->frame_pool_lock);
+
+    if (priv->frame_pool != NULL && uca_frame_pool_get_frame_size (priv->frame_pool) != size) {
+        uca_frame_pool_unref (priv->frame_pool);
+        priv->frame_pool = NULL;
+    }
+
+    if (priv->frame_pool == NULL)
+        priv->frame_pool = uca_frame_pool_new (size, MAX (priv->num_buffers, 1));
+
+    frame = uca_frame_pool_acquire (priv->frame_pool);
+    g_mutex_unlock (&priv->frame_pool_lock);
+
+    if (!uca_camera_grab_with_info (camera, uca_frame_get_data (frame, NULL), uca_frame_get_info (frame), error)) {
+        uca_frame_unref (frame);
+        return NULL;
+    }
+
+    return frame;
+}
+
+/**
+ * uca_camera_get_frame_fd:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #GIOErrorEnum error or %NULL
+ *
+ * Return a file descriptor that can be polled for %G_IO_IN to integrate
+ * buffered acquisition into an event loop such as epoll. The descriptor is
+ * readable as long as uca_camera_grab() would return without blocking, that
+ * is while frames are waiting in the ring buffer or after the acquisition
+ * stopped with an error. Consumers must not read from the descriptor, it is
+ * drained as frames are grabbed. Frames are only signalled while
+ * #UcaCamera:buffered recording is active.
+ *
+ * Returns: A file descriptor owned by @camera or -1 on error.
+ * Since: 2.3
+ */
+gint
+uca_camera_get_frame_fd (UcaCamera *camera, GError **error)
+{
+    UcaCameraPrivate *priv;
+    gint fd;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), -1);
+
+    priv = camera->priv;
+    g_mutex_lock (&priv->buffer_mutex);
+
+    if (priv->frame_fd[0] < 0) {
+#ifdef HAVE_SYS_EVENTFD_H
+        fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (fd < 0) {
+            g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                         "Could not create eventfd: %s", g_strerror (errno));
+        }
+        else {
+            priv->frame_fd[0] = fd;
+            priv->frame_fd[1] = fd;
+        }
+#else
+        gint fds[2];
+
+        if (g_unix_open_pipe (fds, FD_CLOEXEC, error)) {
+            g_unix_set_fd_nonblocking (fds[0], TRUE, NULL);
+            g_unix_set_fd_nonblocking (fds[1], TRUE, NULL);
+            priv->frame_fd[0] = fds[0];
+            priv->frame_fd[1] = fds[1];
+        }
+#endif
+
+        priv->frame_fd_signalled = FALSE;
+        update_frame_fd (priv);
+    }
+
+    fd = priv->frame_fd[0];
+    g_mutex_unlock (&priv->buffer_mutex);
+
+    return fd;
+}
+
+typedef struct {
+    GSource source;
+    UcaCamera *camera;
+    GPollFD poll_fd;
+} FrameSource;
+
+static gboolean
+frame_source_prepare (GSource *source, gint *timeout)
+{
+    *timeout = -1;
+    return FALSE;
+}
+
+static gboolean
+frame_source_check (GSource *source)
+{
+    return (((FrameSource *) source)->poll_fd.revents & G_IO_IN) != 0;
+}
+
+static gboolean
+frame_source_dispatch (GSource *source, GSourceFunc callback, gpointer user_data)
+{
+    if (callback == NULL)
+        return FALSE;
+
+    return callback (user_data);
+}
+
+static void
+frame_source_finalize (GSource *source)
+{
+    g_object_unref (((FrameSource *) source)->camera);
+}
+
+static GSourceFuncs frame_source_funcs = {
+    frame_source_prepare,
+    frame_source_check,
+    frame_source_dispatch,
+    frame_source_finalize,
+};
+
+/**
+ * uca_camera_create_frame_source:
+ * @camera: A #UcaCamera object
+ * @error: Location to store a #GIOErrorEnum error or %NULL
+ *
+ * Create a #GSource that is dispatched whenever a buffered frame can be
+ * grabbed without blocking, see uca_camera_get_frame_fd(). Set a
+ * #GSourceFunc with g_source_set_callback() that calls uca_camera_grab() or
+ * uca_camera_grab_borrow() once and attach the source to a #GMainContext.
+ * The source keeps dispatching until the ring buffer is empty, after the
+ * acquisition stopped the grab returns the error that ended it. This allows
+ * a single thread to serve many cameras without blocking.
+ *
+ * Returns: (transfer full): A new #GSource or %NULL on error.
+ * Since: 2.3
+ */
+GSource *
+uca_camera_create_frame_source (UcaCamera *camera, GError **error)
+{
+    FrameSource *source;
+    gint fd;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), NULL);
+
+    fd = uca_camera_get_frame_fd (camera, error);
+
+    if (fd < 0)
+        return NULL;
+
+    source = (FrameSource *) g_source_new (&frame_source_funcs, sizeof (FrameSource));
+    source->camera = g_object_ref (camera);
+    source->poll_fd.fd = fd;
+    source->poll_fd.events = G_IO_IN | G_IO_ERR;
+    g_source_set_name ((GSource *) source, "UcaCamera frame source");
+    g_source_add_poll ((GSource *) source, &source->poll_fd);
+
+    return (GSource *) source;
+}
+
+static guint
+grab_many_direct (UcaCamera *camera, UcaCameraClass *klass, gpointer *buffers, guint n, UcaFrameInfo *infos, GError **error)
+{
+    UcaCameraPrivate *priv;
+    UcaFrameInfo info;
+    guint n_grabbed = 0;
+
+    priv = camera->priv;
+    lock_access (priv);
+
+    /*
+     * The plugin reports the hardware sequence of the first frame and returns
+     * early without error if the following frames are not consecutive, in
+     * which case the rest is requested in another batch.
+     */
+    if (klass->grab_many != NULL) {
+        while (n_grabbed < n) {
+            GError *tmp_error = NULL;
+            gint64 grab_start;
+            gint64 grab_end;
+            guint n_batch;
+
+            priv->has_hw_sequence = FALSE;
+            uca_trace_begin ("grab_many");
+            grab_start = g_get_monotonic_time ();
+            n_batch = (*klass->grab_many) (camera, buffers + n_grabbed, n - n_grabbed, &tmp_error);
+            grab_end = g_get_monotonic_time ();
+            uca_trace_end ("grab_many");
+
+            if (n_batch > 0)
+                record_frames (priv, n_batch, grab_start, grab_end,
+                               priv->has_hw_sequence ? priv->hw_sequence : priv->sequence);
+
+            for (guint i = 0; i < n_batch; i++) {
+                info.sequence = priv->sequence++;
+                info.hw_sequence = priv->has_hw_sequence ? priv->hw_sequence + i : info.sequence;
+                info.grab_start = grab_start;
+                info.grab_end = grab_end;
+                account_frame (&priv->account, &info);
+
+                if (infos != NULL)
+                    infos[n_grabbed + i] = info;
+            }
+
+            n_grabbed += n_batch;
+
+            if (tmp_error != NULL) {
+                g_propagate_error (error, tmp_error);
+                break;
+            }
+
+            if (n_batch == 0)
+                break;
+        }
+    }
+    else {
+        for (; n_grabbed < n; n_grabbed++) {
+            if (!grab_frame (camera, klass, buffers[n_grabbed], &info, NULL, error))
+                break;
+
+            account_frame (&priv->account, &info);
+
+            if (infos != NULL)
+                infos[n_grabbed] = info;
+        }
+    }
+
+    g_mutex_unlock (&priv->access_lock);
+    return n_grabbed;
+}
+
+static guint
+grab_many_buffered (UcaCamera *camera, gpointer *buffers, guint n, UcaFrameInfo *infos, GError **error)
+{
+    UcaCameraPrivate *priv;
+    gsize size;
+    guint n_grabbed;
+
+    priv = camera->priv;
+    size = uca_ring_buffer_get_block_size (priv->ring_buffer);
+
+    for (n_grabbed = 0; n_grabbed < n; n_grabbed++) {
+        gpointer buffer;
+
+        buffer = take_buffered_frame (priv, NULL, infos != NULL ? &infos[n_grabbed] : NULL, NULL, error);
+
+        if (buffer == NULL)
+            break;
+
+        memcpy (buffers[n_grabbed], buffer, size);
+        uca_camera_frame_release (camera, buffer);
+    }
+
+    return n_grabbed;
+}
+
+/**
+ * uca_camera_grab_many:
+ * @camera: A #UcaCamera object
+ * @buffers: (array length=n): Array of @n pointers to suitably sized data
+ *  buffers
+ * @n: Number of frames to grab
+ * @infos: (array length=n) (allow-none): Array of @n #UcaFrameInfo records
+ *  that receive the frame meta data or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab @n frames in one go. Locks and the Python GIL are taken once for the
+ * whole batch rather than once per frame and cameras that implement the
+ * grab_many virtual method transfer the frames natively. If an error occurs,
+ * the frames grabbed so far remain valid.
+ *
+ * Returns: Number of grabbed frames, which is less than @n on error.
+ * Since: 2.3
+ */
+guint
+uca_camera_grab_many (UcaCamera *camera, gpointer *buffers, guint n, UcaFrameInfo *infos, GError **error)
+{
+    UcaCameraClass *klass;
+    UcaCameraPrivate *priv;
+    guint n_grabbed = 0;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), 0);
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_val_if_fail (klass != NULL, 0);
+    g_return_val_if_fail (klass->grab != NULL, 0);
+    g_return_val_if_fail (buffers != NULL || n == 0, 0);
+
+    priv = camera->priv;
+
+    if (priv->buffered) {
+        if (priv->ring_buffer == NULL) {
+            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                         "Camera is not recording");
+            return 0;
+        }
+
+#ifdef WITH_PYTHON_MULTITHREADING
+        if (Py_IsInitialized ()) {
+            PyGILState_STATE state = PyGILState_Ensure ();
+            Py_BEGIN_ALLOW_THREADS
+
+            n_grabbed = grab_many_buffered (camera, buffers, n, infos, error);
+
+            Py_END_ALLOW_THREADS
+            PyGILState_Release (state);
+        }
+        else {
+            n_grabbed = grab_many_buffered (camera, buffers, n, infos, error);
+        }
+#else
+        n_grabbed = grab_many_buffered (camera, buffers, n, infos, error);
+#endif
+
+        return n_grabbed;
+    }
+
+    g_mutex_lock (&priv->grab_lock);
+
+    if (!priv->is_recording && !priv->is_readout) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera is neither recording nor in readout mode");
+    }
+    else {
+#ifdef WITH_PYTHON_MULTITHREADING
+        if (Py_IsInitialized ()) {
+            PyGILState_STATE state = PyGILState_Ensure ();
+            Py_BEGIN_ALLOW_THREADS
+
+            n_grabbed = grab_many_direct (camera, klass, buffers, n, infos, error);
+
+            Py_END_ALLOW_THREADS
+            PyGILState_Release (state);
+        }
+        else {
+            n_grabbed = grab_many_direct (camera, klass, buffers, n, infos, error);
+        }
+#else
+        n_grabbed = grab_many_direct (camera, klass, buffers, n, infos, error);
+#endif
+    }
+
+    g_mutex_unlock (&priv->grab_lock);
+
+    return n_grabbed;
+}
+
+/**
+ * uca_camera_grab_stack:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to a contiguous buffer of @n times
+ *  uca_camera_get_frame_size() bytes
+ * @n: Number of frames to grab
+ * @infos: (array length=n) (allow-none): Array of @n #UcaFrameInfo records
+ *  that receive the frame meta data or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab @n consecutive frames into a single allocation like
+ * uca_camera_grab_many().
+ *
+ * Returns: Number of grabbed frames, which is less than @n on error.
+ * Since: 2.3
+ */
+guint
+uca_camera_grab_stack (UcaCamera *camera, gpointer data, guint n, UcaFrameInfo *infos, GError **error)
+{
+    gpointer *buffers;
+    gsize size;
+    guint n_grabbed;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), 0);
+    g_return_val_if_fail (data != NULL, 0);
+
+    size = uca_camera_get_frame_size (camera);
+    buffers = g_new (gpointer, n);
+
+    for (guint i = 0; i < n; i++)
+        buffers[i] = ((guint8 *) data) + i * size;
+
+    n_grabbed = uca_camera_grab_many (camera, buffers, n, infos, error);
+    g_free (buffers);
+
+    return n_grabbed;
+}
+
+/**
+ * uca_camera_get_frame_size:
+ * @camera: A #UcaCamera object
+ *
+ * Get the number of bytes that one frame with the current region of interest
+ * and pixel format occupies, see uca_camera_get_frame_format().
+ *
+ * Returns: Size of a frame in bytes.
+ * Since: 2.3
+ */
+gsize
+uca_camera_get_frame_size (UcaCamera *camera)
+{
+    UcaFrameFormat format;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), 0);
+
+    if (camera->priv->ring_buffer != NULL)
+        return uca_ring_buffer_get_block_size (camera->priv->ring_buffer);
+
+    uca_camera_get_frame_format (camera, &format);
+    return format.size;
+}
+
+/**
+ * uca_camera_get_frame_format:
+ * @camera: A #UcaCamera object
+ * @format: (out caller-allocates): Location to store the frame format
+ *
+ * Get the layout of frames delivered with the current settings. Buffers
+ * passed to uca_camera_grab() must hold at least @format->size bytes.
+ * Cameras that do not implement #UcaCameraClass.get_frame_format() deliver
+ * unpacked pixels of the smallest container that fits
+ * #UcaCamera:sensor-bitdepth without row padding. With
+ * #UcaCamera:buffered and #UcaCamera:buffer-unpack set, packed formats are
+ * reported as they come out of the ring buffer, see
+ * uca_unpack_get_frame_format().
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_get_frame_format (UcaCamera *camera, UcaFrameFormat *format)
+{
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (format != NULL);
+
+    UCA_CAMERA_GET_CLASS (camera)->get_frame_format (camera, format);
+
+    if (unpacks_frames (camera->priv))
+        uca_unpack_get_frame_format (format, format);
+}
+
+/**
+ * uca_camera_get_snapshot:
+ * @camera: A #UcaCamera object
+ * @snapshot: (out caller-allocates): Location to store the settings
+ *
+ * Get the acquisition settings of @camera without looking up each property
+ * by name. The values are cached until the next property notification of
+ * @camera, which makes this cheap enough to be called for every frame by
+ * plugins and applications.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_get_snapshot (UcaCamera *camera, UcaCameraSnapshot *snapshot)
+{
+    UcaCameraPrivate *priv;
+    guint serial;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (snapshot != NULL);
+
+    priv = camera->priv;
+    g_mutex_lock (&priv->snapshot_lock);
+
+    if (priv->snapshot_valid) {
+        *snapshot = priv->snapshot;
+        g_mutex_unlock (&priv->snapshot_lock);
+        return;
+    }
+
+    serial = priv->snapshot_serial;
+    g_mutex_unlock (&priv->snapshot_lock);
+
+    /* Property getters may take other locks, so query them unlocked */
+    g_object_get (camera,
+                  "roi-x0", &snapshot->roi_x,
+                  "roi-y0", &snapshot->roi_y,
+                  "roi-width", &snapshot->roi_width,
+                  "roi-height", &snapshot->roi_height,
+                  "sensor-bitdepth", &snapshot->sensor_bitdepth,
+                  "exposure-time", &snapshot->exposure_time,
+                  "trigger-source", &snapshot->trigger_source,
+                  "trigger-type", &snapshot->trigger_type,
+                  NULL);
+
+    uca_camera_get_frame_format (camera, &snapshot->format);
+
+    /* Only cache if no property changed while we were querying */
+    g_mutex_lock (&priv->snapshot_lock);
+
+    if (priv->snapshot_serial == serial) {
+        priv->snapshot = *snapshot;
+        priv->snapshot_valid = TRUE;
+    }
+
+    g_mutex_unlock (&priv->snapshot_lock);
+}
+
+/**
+ * UcaPixelFormat:
+ * @UCA_PIXEL_FORMAT_MONO8: One byte per pixel
+ * @UCA_PIXEL_FORMAT_MONO16: Native endian 16 bit word per pixel, values
+ *      are right-aligned
+ * @UCA_PIXEL_FORMAT_MONO32: Native endian 32 bit word per pixel, values
+ *      are right-aligned
+ * @UCA_PIXEL_FORMAT_MONO10_PACKED: Four pixels in five bytes
+ * @UCA_PIXEL_FORMAT_MONO12_PACKED: Two pixels in three bytes
+ * @UCA_PIXEL_FORMAT_MONO14_PACKED: Four pixels in seven bytes
+ *
+ * Memory layout of a single pixel. Packed formats store pixels as a
+ * continuous little-endian bit stream, i.e. pixel i occupies bits
+ * [i * b, (i + 1) * b) where bit 0 is the least significant bit of the first
+ * byte. This is what GenICam calls Mono10p, Mono12p and Mono14p.
+ * uca_unpack_frame() converts them to #UCA_PIXEL_FORMAT_MONO16.
+ *
+ * Since: 2.3
+ */
+
+/**
+ * UcaFrameFormat:
+ * @pixel_format: A #UcaPixelFormat
+ * @width: Number of pixels per row
+ * @height: Number of rows
+ * @bits: Number of significant bits per pixel
+ * @bits_per_pixel: Number of bits a pixel occupies in memory
+ * @bytes_per_pixel: Number of bytes a pixel occupies in memory or 0 for
+ *      packed formats
+ * @stride: Number of bytes from the start of one row to the next
+ * @padding: Number of unused bytes at the end of each row
+ * @size: Number of bytes of a complete frame
+ *
+ * Describes the memory layout of a frame. Rows always start at a byte
+ * boundary.
+ *
+ * Since: 2.3
+ */
+
+/**
+ * uca_frame_format_init:
+ * @format: A #UcaFrameFormat
+ * @pixel_format: Pixel format
+ * @width: Number of pixels per row
+ * @height: Number of rows
+ * @bits: Number of significant bits per pixel
+ * @padding: Number of unused bytes at the end of each row
+ *
+ * Fill @format and compute its derived fields.
+ *
+ * Since: 2.3
+ */
+void
+uca_frame_format_init (UcaFrameFormat *format,
+                       UcaPixelFormat pixel_format,
+                       guint width,
+                       guint height,
+                       guint bits,
+                       gsize padding)
+{
+    g_return_if_fail (format != NULL);
+
+    format->pixel_format = pixel_format;
+    format->width = width;
+    format->height = height;
+    format->bits_per_pixel = uca_pixel_format_get_bits_per_pixel (pixel_format);
+    format->bits = MIN (bits, format->bits_per_pixel);
+    format->bytes_per_pixel = uca_pixel_format_is_packed (pixel_format) ? 0 : format->bits_per_pixel / 8;
+    format->padding = padding;
+    format->stride = ((gsize) width * format->bits_per_pixel + 7) / 8 + padding;
+    format->size = format->stride * height;
+}
+
+/**
+ * uca_frame_format_copy:
+ * @format: A #UcaFrameFormat
+ *
+ * Return value: (transfer full): A newly allocated copy of @format
+ * Since: 2.3
+ */
+UcaFrameFormat *
+uca_frame_format_copy (const UcaFrameFormat *format)
+{
+    g_return_val_if_fail (format != NULL, NULL);
+    return g_slice_dup (UcaFrameFormat, format);
+}
+
+/**
+ * uca_frame_format_free:
+ * @format: A #UcaFrameFormat allocated with uca_frame_format_copy()
+ *
+ * Since: 2.3
+ */
+void
+uca_frame_format_free (UcaFrameFormat *format)
+{
+    g_slice_free (UcaFrameFormat, format);
+}
+
+/**
+ * uca_pixel_format_from_bitdepth:
+ * @bits: Number of significant bits per pixel
+ *
+ * Return value: The unpacked #UcaPixelFormat with the smallest container
+ *      that holds @bits.
+ * Since: 2.3
+ */
+UcaPixelFormat
+uca_pixel_format_from_bitdepth (guint bits)
+{
+    if (bits <= 8)
+        return UCA_PIXEL_FORMAT_MONO8;
+
+    if (bits <= 16)
+        return UCA_PIXEL_FORMAT_MONO16;
+
+    return UCA_PIXEL_FORMAT_MONO32;
+}
+
+/**
+ * uca_pixel_format_get_bits_per_pixel:
+ * @pixel_format: A #UcaPixelFormat
+ *
+ * Return value: Number of bits a pixel of @pixel_format occupies in memory.
+ * Since: 2.3
+ */
+guint
+uca_pixel_format_get_bits_per_pixel (UcaPixelFormat pixel_format)
+{
+    switch (pixel_format) {
+        case UCA_PIXEL_FORMAT_MONO8:
+            return 8;
+        case UCA_PIXEL_FORMAT_MONO16:
+            return 16;
+        case UCA_PIXEL_FORMAT_MONO32:
+            return 32;
+        case UCA_PIXEL_FORMAT_MONO10_PACKED:
+            return 10;
+        case UCA_PIXEL_FORMAT_MONO12_PACKED:
+            return 12;
+        case UCA_PIXEL_FORMAT_MONO14_PACKED:
+            return 14;
+    }
+
+    g_return_val_if_reached (0);
+}
+
+/**
+ * uca_pixel_format_is_packed:
+ * @pixel_format: A #UcaPixelFormat
+ *
+ * Return value: %TRUE if pixels of @pixel_format do not start at byte
+ *      boundaries.
+ * Since: 2.3
+ */
+gboolean
+uca_pixel_format_is_packed (UcaPixelFormat pixel_format)
+{
+    return pixel_format == UCA_PIXEL_FORMAT_MONO10_PACKED ||
+           pixel_format == UCA_PIXEL_FORMAT_MONO12_PACKED ||
+           pixel_format == UCA_PIXEL_FORMAT_MONO14_PACKED;
+}
+
+/**
+ * uca_camera_readout:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @index: Index of in-camera frame to be grabbed
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a frame a single frame and store the result in @data.
+ *
+ * You must have called uca_camera_start_recording() before, otherwise you will
+ * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ *
+ * Since: 2.1
+ */
+gboolean
+uca_camera_readout (UcaCamera *camera, gpointer data, guint index, GError **error)
+{
+    UcaCameraClass *klass;
+    gboolean result = FALSE;
+
+
+    g_return_val_if_fail (UCA_IS_CAMERA(camera), FALSE);
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    g_return_val_if_fail (klass != NULL, FALSE);
+    g_return_val_if_fail (klass->readout != NULL, FALSE);
+    g_return_val_if_fail (data != NULL, FALSE);
+
+    if (camera->priv->buffered) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Cannot grab specific frame in buffered mode");
+        return FALSE;
+    }
+
+    g_mutex_lock (&camera->priv->grab_lock);
+
+    if (!camera->priv->is_recording && !camera->priv->is_readout) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera is not in readout or record mode");
+    }
+    else {
+        g_mutex_lock (&camera->priv->access_lock);
+        uca_trace_begin ("readout");
+
+#ifdef WITH_PYTHON_MULTITHREADING
+        if (Py_IsInitialized ()) {
+            PyGILState_STATE state = PyGILState_Ensure ();
+            Py_BEGIN_ALLOW_THREADS
+
+            result = (*klass->readout) (camera, data, index, error);
+
+            Py_END_ALLOW_THREADS
+            PyGILState_Release (state);
+        }
+        else {
+            result = (*klass->readout) (camera, data, index, error);
+        }
+#else
+        result = (*klass->readout) (camera, data, index, error);
+#endif
+
+        uca_trace_end ("readout");
+        g_mutex_unlock (&camera->priv->access_lock);
+    }
+
+    g_mutex_unlock (&camera->priv->grab_lock);
+
+    return result;
+}
+
+typedef struct {
+    gpointer data;
+    guint index;
+    UcaFrameInfo info;
+} AsyncGrabData;
+
+static void
+async_grab_data_free (AsyncGrabData *grab_data)
+{
+    g_slice_free (AsyncGrabData, grab_data);
+}
+
+static GTask *
+async_grab_task_new (UcaCamera *camera, gpointer data, guint index, GCancellable *cancellable,
+                     GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+    AsyncGrabData *grab_data;
+    GTask *task;
+
+    grab_data = g_slice_new0 (AsyncGrabData);
+    grab_data->data = data;
+    grab_data->index = index;
+
+    task = g_task_new (camera, cancellable, callback, user_data);
+    g_task_set_source_tag (task, source_tag);
+    g_task_set_task_data (task, grab_data, (GDestroyNotify) async_grab_data_free);
+
+    return task;
+}
+
+static void
+grab_thread_func (GTask *task, UcaCamera *camera, AsyncGrabData *grab_data, GCancellable *cancellable)
+{
+    GError *error = NULL;
+
+    if (uca_camera_grab_full (camera, grab_data->data, &grab_data->info, cancellable, &error))
+        g_task_return_boolean (task, TRUE);
+    else
+        g_task_return_error (task, error);
+}
+
+static void
+readout_thread_func (GTask *task, UcaCamera *camera, AsyncGrabData *grab_data, GCancellable *cancellable)
+{
+    GError *error = NULL;
+
+    /* Plugins cannot interrupt a readout, skip it if we are too late */
+    if (g_task_return_error_if_cancelled (task))
+        return;
+
+    if (uca_camera_readout (camera, grab_data->data, grab_data->index, &error))
+        g_task_return_boolean (task, TRUE);
+    else
+        g_task_return_error (task, error);
+}
+
+/*
+ * Asynchronous grabs and readouts block until the camera delivers, possibly
+ * waiting for an external trigger. They run on a pool of the camera instead of
+ * the shared GTask pool, where they would starve unrelated GIO work.
+ */
+static void
+async_worker (GTask *task, gpointer unused)
+{
+    UcaCamera *camera;
+    AsyncGrabData *grab_data;
+    GCancellable *cancellable;
+
+    camera = g_task_get_source_object (task);
+    grab_data = g_task_get_task_data (task);
+    cancellable = g_task_get_cancellable (task);
+
+    if (g_task_get_source_tag (task) == uca_camera_grab_async)
+        grab_thread_func (task, camera, grab_data, cancellable);
+    else
+        readout_thread_func (task, camera, grab_data, cancellable);
+
+    g_object_unref (task);
+}
+
+static void
+run_async_task (UcaCamera *camera, GTask *task)
+{
+    g_thread_pool_push (camera->priv->async_pool, task, NULL);
+}
+
+/**
+ * uca_camera_grab_async:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer that must stay
+ *  valid until @callback is called. Must not be %NULL.
+ * @cancellable: (allow-none): A #GCancellable or %NULL
+ * @callback: (scope async): Function to call when the frame was grabbed
+ * @user_data: (closure): Data passed to @callback
+ *
+ * Grab a frame like uca_camera_grab_full() on a worker thread of @camera, so
+ * that a grab waiting for a trigger does not hold up other asynchronous work
+ * of the application. @callback is
+ * invoked in the thread-default main context of the caller, where
+ * uca_camera_grab_finish() must be called to get the result. Several grabs
+ * can be outstanding at the same time, they are served in no particular
+ * order.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_grab_async (UcaCamera *camera, gpointer data, GCancellable *cancellable,
+                       GAsyncReadyCallback callback, gpointer user_data)
+{
+    GTask *task;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (data != NULL);
+
+    task = async_grab_task_new (camera, data, 0, cancellable, callback, user_data, uca_camera_grab_async);
+    run_async_task (camera, task);
+}
+
+/**
+ * uca_camera_grab_finish:
+ * @camera: A #UcaCamera object
+ * @result: The #GAsyncResult passed to the callback
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
+ * @error: Location to store a #UcaCameraError or #GIOErrorEnum error or %NULL
+ *
+ * Finish a grab started with uca_camera_grab_async().
+ *
+ * Returns: %TRUE if the frame was written into the buffer.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_grab_finish (UcaCamera *camera, GAsyncResult *result, UcaFrameInfo *info, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, camera), FALSE);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == uca_camera_grab_async, FALSE);
+
+    if (!g_task_propagate_boolean (G_TASK (result), error))
+        return FALSE;
+
+    if (info != NULL)
+        *info = ((AsyncGrabData *) g_task_get_task_data (G_TASK (result)))->info;
+
+    return TRUE;
+}
+
+/**
+ * uca_camera_readout_async:
+ * @camera: A #UcaCamera object
+ * @data: (type gulong): Pointer to suitably sized data buffer that must stay
+ *  valid until @callback is called. Must not be %NULL.
+ * @index: Index of in-camera frame to be read
+ * @cancellable: (allow-none): A #GCancellable or %NULL
+ * @callback: (scope async): Function to call when the frame was read
+ * @user_data: (closure): Data passed to @callback
+ *
+ * Read a frame like uca_camera_readout() on a worker thread of @camera.
+ * @callback is
+ * invoked in the thread-default main context of the caller, where
+ * uca_camera_readout_finish() must be called to get the result. Cancelling
+ * skips readouts that have not started yet.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_readout_async (UcaCamera *camera, gpointer data, guint index, GCancellable *cancellable,
+                          GAsyncReadyCallback callback, gpointer user_data)
+{
+    GTask *task;
+
+    g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (data != NULL);
+
+    task = async_grab_task_new (camera, data, index, cancellable, callback, user_data, uca_camera_readout_async);
+    run_async_task (camera, task);
+}
+
+/**
+ * uca_camera_readout_finish:
+ * @camera: A #UcaCamera object
+ * @result: The #GAsyncResult passed to the callback
+ * @error: Location to store a #UcaCameraError or #GIOErrorEnum error or %NULL
+ *
+ * Finish a readout started with uca_camera_readout_async().
+ *
+ * Returns: %TRUE if the frame was written into the buffer.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_readout_finish (UcaCamera *camera, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, camera), FALSE);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == uca_camera_readout_async, FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+readout_range_cancelled (GCancellable *cancellable, UcaCameraReadoutRange *range)
+{
+    g_mutex_lock (&range->lock);
+    g_cond_broadcast (&range->cond);
+    g_mutex_unlock (&range->lock);
+}
+
+static gboolean
+readout_range_stopped (UcaCameraReadoutRange *range)
+{
+    return range->stop || g_cancellable_is_cancelled (range->cancellable);
+}
+
+/*
+ * Reads frames ahead of the consumer until the ring buffer is full. The camera
+ * locks are only held while a single frame is transferred, so that other
+ * calls can interleave.
+ */
+static gpointer
+readout_range_thread (UcaCameraReadoutRange *range)
+{
+    UcaCamera *camera;
+    UcaCameraClass *klass;
+    GError *error = NULL;
+
+    camera = range->camera;
+    klass = UCA_CAMERA_GET_CLASS (camera);
+
+    for (guint i = 0; i < range->count; i++) {
+        UcaFrameInfo *info;
+        gpointer buffer;
+        gboolean result;
+
+        g_mutex_lock (&range->lock);
+
+        while ((buffer = uca_ring_buffer_get_write_pointer (range->ring_buffer)) == NULL &&
+               !readout_range_stopped (range))
+            g_cond_wait (&range->cond, &range->lock);
+
+        g_mutex_unlock (&range->lock);
+
+        if (readout_range_stopped (range))
+            break;
+
+        info = uca_ring_buffer_get_info (range->ring_buffer, buffer);
+        info->grab_start = g_get_monotonic_time ();
+
+        g_mutex_lock (&camera->priv->grab_lock);
+        g_mutex_lock (&camera->priv->access_lock);
+        uca_trace_begin ("readout");
+        result = (*klass->readout) (camera, buffer, range->first + i, &error);
+        uca_trace_end ("readout");
+        g_mutex_unlock (&camera->priv->access_lock);
+        g_mutex_unlock (&camera->priv->grab_lock);
+
+        if (!result)
+            break;
+
+        info->grab_end = g_get_monotonic_time ();
+        info->sequence = i;
+        info->hw_sequence = range->first + i;
+        info->n_dropped = 0;
+
+        g_mutex_lock (&range->lock);
+        uca_ring_buffer_write_advance (range->ring_buffer);
+        g_cond_broadcast (&range->cond);
+        g_mutex_unlock (&range->lock);
+
+        if (range->progress != NULL)
+            range->progress (i + 1, range->count, range->user_data);
+    }
+
+    g_mutex_lock (&range->lock);
+    range->error = error;
+    range->done = TRUE;
+    g_cond_broadcast (&range->cond);
+    g_mutex_unlock (&range->lock);
+
+    return NULL;
+}
+
+/**
+ * uca_camera_readout_range:
+ * @camera: A #UcaCamera object
+ * @first: Index of the first in-camera frame
+ * @count: Number of frames to read out
+ * @cancellable: (allow-none): A #GCancellable to stop the transfer or %NULL
+ * @progress: (allow-none): Function called after each
+ *  transferred frame or %NULL
+ * @user_data: (closure progress): Data passed to @progress
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Read out the in-camera frames @first to @first + @count - 1 like
+ * uca_camera_readout() but from a background thread that fetches frames ahead
+ * into a ring buffer of #UcaCamera:num-buffers blocks. Frames are picked up in
+ * order with uca_camera_readout_range_grab(), so that the transfer of the next
+ * frames overlaps with processing the current one.
+ *
+ * @progress is called from the background thread. Cancelling @cancellable
+ * stops the transfer and wakes up a waiting uca_camera_readout_range_grab().
+ * The range must be freed before readout or recording is stopped.
+ *
+ * Returns: (transfer full): A new #UcaCameraReadoutRange to be freed with
+ *  uca_camera_readout_range_free() or %NULL on error.
+ * Since: 2.3
+ */
+UcaCameraReadoutRange *
+uca_camera_readout_range (UcaCamera *camera,
+                          guint first,
+                          guint count,
+                          GCancellable *cancellable,
+                          UcaCameraProgressFunc progress,
+                          gpointer user_data,
+                          GError **error)
+{
+    UcaCameraClass *klass;
+    UcaCameraPrivate *priv;
+    UcaCameraReadoutRange *range;
+
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), NULL);
+
+    klass = UCA_CAMERA_GET_CLASS (camera);
+    priv = camera->priv;
+
+    if (klass->readout == NULL) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
+                     "Camera does not support reading out in-camera frames");
+        return NULL;
+    }
+
+    if (priv->buffered) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
+                     "Cannot grab specific frame in buffered mode");
+        return NULL;
+    }
+
+    if (!priv->is_recording && !priv->is_readout) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
+                     "Camera is not in readout or record mode");
+        return NULL;
+    }
+
+    range = g_new0 (UcaCameraReadoutRange, 1);
+    range->ref_count = 1;
+    range->camera = g_object_ref (camera);
+    range->first = first;
+    range->count = count;
+    range->progress = progress;
+    range->user_data = user_data;
+
+    /* With a single block the transfer could not overlap with the consumer */
+    range->ring_buffer = uca_ring_buffer_new_full (uca_camera_get_frame_size (camera),
+                                                   MAX (priv->num_buffers, 2),
+                                                   priv->buffer_alloc_flags,
+                                                   priv->buffer_numa_node);
+    uca_ring_buffer_set_overrun_policy (range->ring_buffer, UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK);
+
+    g_mutex_init (&range->lock);
+    g_cond_init (&range->cond);
+
+    if (cancellable != NULL) {
+        range->cancellable = g_object_ref (cancellable);
+        range->cancelled_id = g_cancellable_connect (cancellable, G_CALLBACK (readout_range_cancelled),
+                                                     range, NULL);
+    }
+
+    range->thread = g_thread_new ("readout-thread", (GThreadFunc) readout_range_thread, range);
+
+    return range;
+}
+
+static gpointer
+take_readout_frame (UcaCameraReadoutRange *range, UcaFrameInfo *info, GError **error)
+{
+    gpointer buffer = NULL;
+
+    g_mutex_lock (&range->lock);
+
+    while (!uca_ring_buffer_available (range->ring_buffer) &&
+           !range->done && !g_cancellable_is_cancelled (range->cancellable))
+        g_cond_wait (&range->cond, &range->lock);
+
+    if (g_cancellable_set_error_if_cancelled (range->cancellable, error)) {
+        /* Error is set */
+    }
+    else if (uca_ring_buffer_available (range->ring_buffer)) {
+        buffer = uca_ring_buffer_borrow_read_pointer (range->ring_buffer);
 
-    if (camera->priv->is_recording) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
-                     "Camera is still recording");
+        if (info != NULL)
+            *info = *uca_ring_buffer_get_info (range->ring_buffer, buffer);
+    }
+    else if (range->error != NULL) {
+        g_propagate_error (error, g_error_copy (range->error));
     }
     else {
-        GError *tmp_error = NULL;
-
-        g_static_mutex_lock (&access_lock);
-        (*klass->start_readout) (camera, &tmp_error);
-        g_static_mutex_unlock (&access_lock);
-
-        if (tmp_error == NULL) {
-            camera->priv->is_readout = TRUE;
-            /* TODO: we should depend on GLib 2.26 and use g_object_notify_by_pspec */
-            g_object_notify (G_OBJECT (camera), "is-readout");
-        }
-        else
-            g_propagate_error (error, tmp_error);
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
+                     "All %u frames have been read out", range->count);
     }
 
-    g_static_mutex_unlock (&mutex);
+    g_mutex_unlock (&range->lock);
+
+    return buffer;
 }
 
 /**
- * uca_camera_stop_readout:
- * @camera: A #UcaCamera object
+ * uca_camera_readout_range_grab:
+ * @range: A #UcaCameraReadoutRange
+ * @data: (type gulong): Pointer to a buffer of uca_camera_get_frame_size()
+ *  bytes. Must not be %NULL.
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL. Its hw_sequence is the in-camera index of the frame.
  * @error: Location to store a #UcaCameraError error or %NULL
  *
- * Stop reading out frames.
+ * Wait for the next frame of @range and copy it to @data. Frames that were
+ * read before the transfer failed are still handed out, after the last one
+ * the transfer error or #UCA_CAMERA_ERROR_END_OF_STREAM is reported. If the
+ * #GCancellable passed to uca_camera_readout_range() was cancelled,
+ * #G_IO_ERROR_CANCELLED is reported right away.
  *
- * Since: 1.1
+ * Returns: %TRUE if @data holds a new frame.
+ * Since: 2.3
  */
-void
-uca_camera_stop_readout (UcaCamera *camera, GError **error)
+gboolean
+uca_camera_readout_range_grab (UcaCameraReadoutRange *range, gpointer data, UcaFrameInfo *info, GError **error)
 {
-    UcaCameraClass *klass;
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
+    gpointer buffer;
 
-    g_return_if_fail (UCA_IS_CAMERA(camera));
-
-    klass = UCA_CAMERA_GET_CLASS(camera);
+    g_return_val_if_fail (range != NULL, FALSE);
+    g_return_val_if_fail (data != NULL, FALSE);
 
-    g_return_if_fail (klass != NULL);
-    g_return_if_fail (klass->stop_readout != NULL);
+#ifdef WITH_PYTHON_MULTITHREADING
+    if (Py_IsInitialized ()) {
+        PyGILState_STATE state = PyGILState_Ensure ();
+        Py_BEGIN_ALLOW_THREADS
 
-    g_static_mutex_lock (&mutex);
+        buffer = take_readout_frame (range, info, error);
 
-    if (camera->priv->is_recording) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
-                     "Camera is still recording");
+        Py_END_ALLOW_THREADS
+        PyGILState_Release (state);
     }
     else {
-        GError *tmp_error = NULL;
+        buffer = take_readout_frame (range, info, error);
+    }
+#else
+    buffer = take_readout_frame (range, info, error);
+#endif
 
-        g_static_mutex_lock (&access_lock);
-        (*klass->stop_readout) (camera, &tmp_error);
-        g_static_mutex_unlock (&access_lock);
+    if (buffer == NULL)
+        return FALSE;
 
-        if (tmp_error == NULL) {
-            camera->priv->is_readout = FALSE;
-            g_object_notify (G_OBJECT (camera), "is-readout");
-        }
-        else
-            g_propagate_error (error, tmp_error);
-    }
+    memcpy (data, buffer, uca_ring_buffer_get_block_size (range->ring_buffer));
+
+    g_mutex_lock (&range->lock);
+    uca_ring_buffer_release_pointer (range->ring_buffer, buffer);
+    g_cond_broadcast (&range->cond);
+    g_mutex_unlock (&range->lock);
 
-    g_static_mutex_unlock (&mutex);
+    return TRUE;
 }
 
 /**
- * uca_camera_set_grab_func:
- * @camera: A #UcaCamera object
- * @func: (scope call): A #UcaCameraGrabFunc callback function
- * @user_data: (closure): Data that is passed on to #func
+ * uca_camera_readout_range_ref:
+ * @range: A #UcaCameraReadoutRange
  *
- * Set the grab function that is called whenever a frame is readily transfered.
+ * Returns: (transfer full): @range
+ * Since: 2.3
  */
-void
-uca_camera_set_grab_func(UcaCamera *camera, UcaCameraGrabFunc func, gpointer user_data)
+UcaCameraReadoutRange *
+uca_camera_readout_range_ref (UcaCameraReadoutRange *range)
 {
-    camera->grab_func = func;
-    camera->user_data = user_data;
+    g_return_val_if_fail (range != NULL, NULL);
+    g_atomic_int_inc (&range->ref_count);
+    return range;
 }
 
 /**
- * uca_camera_trigger:
- * @camera: A #UcaCamera object
- * @error: Location to store a #UcaCameraError error or %NULL
+ * uca_camera_readout_range_free:
+ * @range: A #UcaCameraReadoutRange
  *
- * Trigger from software if supported by camera.
+ * Drop a reference of @range. The last reference stops the transfer if it is
+ * still running and frees @range.
  *
- * You must have called uca_camera_start_recording() before, otherwise you will
- * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ * Since: 2.3
  */
 void
-uca_camera_trigger (UcaCamera *camera, GError **error)
+uca_camera_readout_range_free (UcaCameraReadoutRange *range)
 {
-    UcaCameraClass *klass;
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
+    g_return_if_fail (range != NULL);
 
-    g_return_if_fail (UCA_IS_CAMERA (camera));
+    if (!g_atomic_int_dec_and_test (&range->ref_count))
+        return;
 
-    klass = UCA_CAMERA_GET_CLASS (camera);
+    g_mutex_lock (&range->lock);
+    range->stop = TRUE;
+    g_cond_broadcast (&range->cond);
+    g_mutex_unlock (&range->lock);
 
-    g_return_if_fail (klass != NULL);
-    g_return_if_fail (klass->trigger != NULL);
+    g_thread_join (range->thread);
+
+    if (range->cancellable != NULL) {
+        g_cancellable_disconnect (range->cancellable, range->cancelled_id);
+        g_object_unref (range->cancellable);
+    }
 
-    g_static_mutex_lock (&mutex);
+    g_clear_error (&range->error);
+    g_object_unref (range->ring_buffer);
+    g_object_unref (range->camera);
+    g_mutex_clear (&range->lock);
+    g_cond_clear (&range->cond);
+    g_free (range);
+}
 
-    if (!camera->priv->is_recording)
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING, "Camera is not recording");
-    else {
-        (*klass->trigger) (camera, error);
+/**
+ * uca_camera_grab_borrow:
+ * @camera: A #UcaCamera object
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Grab a single frame in buffered mode without copying it. The returned
+ * pointer points directly into the internal ring buffer and the block is not
+ * overwritten until it is handed back with uca_camera_frame_release(). All
+ * borrowed frames must be released before calling
+ * uca_camera_stop_recording().
+ *
+ * You must have set #UcaCamera:buffered to %TRUE and called
+ * uca_camera_start_recording() before.
+ *
+ * Returns: (transfer none): Pointer to the frame data or %NULL on error.
+ * Since: 2.3
+ */
+gpointer
+uca_camera_grab_borrow (UcaCamera *camera, UcaFrameInfo *info, GError **error)
+{
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), NULL);
+
+    if (!camera->priv->buffered) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
+                     "Borrowing frames is only possible in buffered mode");
+        return NULL;
     }
 
-    g_static_mutex_unlock (&mutex);
+    return borrow_buffered_frame (camera, NULL, info, NULL, error);
 }
 
 /**
- * uca_camera_write:
+ * uca_camera_frame_release:
  * @camera: A #UcaCamera object
- * @name: String that identifies the written data.
- * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
- *  %NULL.
- * @size: Size of the data buffer in bytes.
- * @error: Location to store a #UcaCameraError or %NULL.
+ * @data: Frame pointer returned by uca_camera_grab_borrow()
  *
- * Writes camera-specific @data containing @size bytes and identified by @name.
+ * Hand a borrowed frame back so that its ring buffer block can be re-used
+ * for new frames.
+ *
+ * Since: 2.3
  */
 void
-uca_camera_write (UcaCamera *camera, const gchar *name, gpointer data, gsize size, GError **error)
+uca_camera_frame_release (UcaCamera *camera, gpointer data)
 {
-    UcaCameraClass *klass;
+    UcaCameraPrivate *priv;
 
     g_return_if_fail (UCA_IS_CAMERA (camera));
+    g_return_if_fail (data != NULL);
 
-    klass = UCA_CAMERA_GET_CLASS (camera);
-
-    g_return_if_fail (klass != NULL);
+    priv = camera->priv;
+    g_return_if_fail (priv->ring_buffer != NULL);
 
-    if (klass->write == NULL) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
-                     "`%s' does not provide a `write' method",
-                     G_OBJECT_TYPE_NAME (G_OBJECT (camera)));
-    }
-    else {
-        (*klass->write) (camera, name, data, size, error);
-    }
+    g_mutex_lock (&priv->buffer_mutex);
+    uca_ring_buffer_release_pointer (priv->ring_buffer, data);
+    g_cond_broadcast (&priv->buffer_cond);
+    g_mutex_unlock (&priv->buffer_mutex);
 }
 
 /**
- * uca_camera_grab:
+ * uca_camera_set_hardware_sequence:
  * @camera: A #UcaCamera object
- * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
- *  %NULL.
- * @error: Location to store a #UcaCameraError error or %NULL
+ * @sequence: Frame number reported by the camera hardware
  *
- * Grab a frame a single frame and store the result in @data.
+ * Camera plugins call this from their grab implementation to report the frame
+ * number assigned by the camera. It ends up in #UcaFrameInfo.hw_sequence and
+ * is used to detect frames that were lost in hardware.
  *
- * You must have called uca_camera_start_recording() before, otherwise you will
- * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ * Since: 2.3
  */
-gboolean
-uca_camera_grab (UcaCamera *camera, gpointer data, GError **error)
+void
+uca_camera_set_hardware_sequence (UcaCamera *camera, guint64 sequence)
 {
-    UcaCameraClass *klass;
-    gboolean result = FALSE;
+    g_return_if_fail (UCA_IS_CAMERA (camera));
 
-    /* FIXME: this prevents accessing two independent cameras simultanously. */
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
+    camera->priv->hw_sequence = sequence;
+    camera->priv->has_hw_sequence = TRUE;
+}
 
-    g_return_val_if_fail (UCA_IS_CAMERA(camera), FALSE);
+/**
+ * uca_camera_subscribe:
+ * @camera: A #UcaCamera object
+ * @policy: How the subscriber deals with frames it could not keep up with
+ *
+ * Attach an additional reader to the ring buffer of @camera in buffered mode.
+ * Each subscriber has its own read cursor and frames are shared among all
+ * readers instead of being copied.
+ *
+ * A #UCA_CAMERA_SUBSCRIBER_LOSSLESS subscriber receives every frame written
+ * to the ring buffer. Its unread frames stay pinned and are not available to
+ * the writer. A lossless subscriber that falls behind therefore slows down
+ * the whole acquisition: once all #UcaCamera:num-buffers blocks are pinned,
+ * #UcaCamera:overrun-policy decides whether acquisition blocks or new frames
+ * are dropped for every reader. A #UCA_CAMERA_SUBSCRIBER_LATEST subscriber
+ * only ever gets the newest frame and pins nothing until it borrows one,
+ * which makes it suitable for live previews.
+ *
+ * Subscribers require #UcaCamera:num-buffers to be at least two. A subscriber
+ * holds a reference on @camera until it is freed.
+ *
+ * Returns: (transfer full): A new #UcaCameraSubscriber, free it with
+ *  uca_camera_unsubscribe().
+ * Since: 2.3
+ */
+UcaCameraSubscriber *
+uca_camera_subscribe (UcaCamera *camera, UcaCameraSubscriberPolicy policy)
+{
+    UcaCameraSubscriber *subscriber;
 
-    klass = UCA_CAMERA_GET_CLASS (camera);
+    g_return_val_if_fail (UCA_IS_CAMERA (camera), NULL);
 
-    g_return_val_if_fail (klass != NULL, FALSE);
-    g_return_val_if_fail (klass->grab != NULL, FALSE);
-    g_return_val_if_fail (data != NULL, FALSE);
+    subscriber = g_new0 (UcaCameraSubscriber, 1);
+    subscriber->camera = g_object_ref (camera);
+    subscriber->policy = policy;
+    subscriber->pending = g_queue_new ();
 
-    if (!camera->priv->buffered) {
-        g_static_mutex_lock (&mutex);
+    g_mutex_lock (&camera->priv->buffer_mutex);
+    camera->priv->subscribers = g_list_append (camera->priv->subscribers, subscriber);
+    g_mutex_unlock (&camera->priv->buffer_mutex);
 
-        if (!camera->priv->is_recording && !camera->priv->is_readout) {
-            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
-                         "Camera is neither recording nor in readout mode");
-        }
-        else {
-#ifdef WITH_PYTHON_MULTITHREADING
-            if (Py_IsInitialized ()) {
-                PyGILState_STATE state = PyGILState_Ensure ();
-                Py_BEGIN_ALLOW_THREADS
+    return subscriber;
+}
 
-                g_static_mutex_lock (&access_lock);
-                result = (*klass->grab) (camera, data, error);
-                g_static_mutex_unlock (&access_lock);
+/**
+ * uca_camera_unsubscribe:
+ * @subscriber: A #UcaCameraSubscriber
+ *
+ * Detach @subscriber from its camera, free it and drop its reference on the
+ * camera. Frames it has not read yet are unpinned, frames it borrowed must
+ * have been released before.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_unsubscribe (UcaCameraSubscriber *subscriber)
+{
+    UcaCameraPrivate *priv;
 
-                Py_END_ALLOW_THREADS
-                PyGILState_Release (state);
-            }
-            else {
-                g_static_mutex_lock (&access_lock);
-                result = (*klass->grab) (camera, data, error);
-                g_static_mutex_unlock (&access_lock);
-            }
-#else
-            g_static_mutex_lock (&access_lock);
-            result = (*klass->grab) (camera, data, error);
-            g_static_mutex_unlock (&access_lock);
-#endif
-        }
+    g_return_if_fail (subscriber != NULL);
 
-        g_static_mutex_unlock (&mutex);
-    }
-    else {
-        gpointer buffer;
+    priv = subscriber->camera->priv;
+    g_mutex_lock (&priv->buffer_mutex);
 
-        if (camera->priv->ring_buffer == NULL)
-            return FALSE;
+    priv->subscribers = g_list_remove (priv->subscribers, subscriber);
 
-        /*
-         * Spin-lock until we can read something. This shouldn't happen to
-         * often, as buffering is usually used in those cases when the camera is
-         * faster than the software.
-         */
-        while (!uca_ring_buffer_available (camera->priv->ring_buffer))
-            ;
+    if (priv->ring_buffer != NULL) {
+        while (!g_queue_is_empty (subscriber->pending))
+            uca_ring_buffer_release_pointer (priv->ring_buffer, g_queue_pop_head (subscriber->pending));
+    }
 
-        buffer = uca_ring_buffer_get_read_pointer (camera->priv->ring_buffer);
+    g_cond_broadcast (&priv->buffer_cond);
+    g_mutex_unlock (&priv->buffer_mutex);
 
-        if (buffer == NULL) {
-            g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM,
-                         "Ring buffer is empty");
-        }
-        else {
-            memcpy (data, buffer, uca_ring_buffer_get_block_size (camera->priv->ring_buffer));
-            result = TRUE;
-        }
-    }
-    return result;
+    g_queue_free (subscriber->pending);
+    g_object_unref (subscriber->camera);
+    g_free (subscriber);
 }
 
 /**
- * uca_camera_readout:
- * @camera: A #UcaCamera object
- * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
- *  %NULL.
- * @index: Index of in-camera frame to be grabbed
+ * uca_camera_subscriber_borrow:
+ * @subscriber: A #UcaCameraSubscriber
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
  * @error: Location to store a #UcaCameraError error or %NULL
  *
- * Grab a frame a single frame and store the result in @data.
- *
- * You must have called uca_camera_start_recording() before, otherwise you will
- * get a #UCA_CAMERA_ERROR_NOT_RECORDING error.
+ * Borrow the next frame for @subscriber like uca_camera_grab_borrow(). The
+ * frame must be handed back with uca_camera_subscriber_release().
  *
- * Since: 2.1
+ * Returns: (transfer none): Pointer to the frame data or %NULL on error.
+ * Since: 2.3
  */
-gboolean
-uca_camera_readout (UcaCamera *camera, gpointer data, guint index, GError **error)
+gpointer
+uca_camera_subscriber_borrow (UcaCameraSubscriber *subscriber, UcaFrameInfo *info, GError **error)
 {
-    UcaCameraClass *klass;
-    gboolean result = FALSE;
-
-    /* FIXME: this prevents accessing two independent cameras simultanously. */
-    static GStaticMutex mutex = G_STATIC_MUTEX_INIT;
+    UcaCamera *camera;
 
-    g_return_val_if_fail (UCA_IS_CAMERA(camera), FALSE);
-
-    klass = UCA_CAMERA_GET_CLASS (camera);
+    g_return_val_if_fail (subscriber != NULL, NULL);
 
-    g_return_val_if_fail (klass != NULL, FALSE);
-    g_return_val_if_fail (klass->readout != NULL, FALSE);
-    g_return_val_if_fail (data != NULL, FALSE);
+    camera = subscriber->camera;
 
-    if (camera->priv->buffered) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_RECORDING,
-                     "Cannot grab specific frame in buffered mode");
-        return FALSE;
+    if (!camera->priv->buffered) {
+        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
+                     "Subscribers are only supported in buffered mode");
+        return NULL;
     }
 
-    g_static_mutex_lock (&mutex);
-
-    if (!camera->priv->is_recording && !camera->priv->is_readout) {
-        g_set_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING,
-                     "Camera is not in readout or record mode");
-    }
-    else {
-        g_static_mutex_lock (&access_lock);
+    return borrow_buffered_frame (camera, subscriber, info, NULL, error);
+}
 
-#ifdef WITH_PYTHON_MULTITHREADING
-        if (Py_IsInitialized ()) {
-            PyGILState_STATE state = PyGILState_Ensure ();
-            Py_BEGIN_ALLOW_THREADS
+/**
+ * uca_camera_subscriber_release:
+ * @subscriber: A #UcaCameraSubscriber
+ * @data: Frame pointer returned by uca_camera_subscriber_borrow()
+ *
+ * Hand a borrowed frame back.
+ *
+ * Since: 2.3
+ */
+void
+uca_camera_subscriber_release (UcaCameraSubscriber *subscriber, gpointer data)
+{
+    g_return_if_fail (subscriber != NULL);
+    uca_camera_frame_release (subscriber->camera, data);
+}
 
-            result = (*klass->readout) (camera, data, index, error);
+/**
+ * uca_camera_subscriber_grab:
+ * @subscriber: A #UcaCameraSubscriber
+ * @data: (type gulong): Pointer to suitably sized data buffer. Must not be
+ *  %NULL.
+ * @info: (out caller-allocates) (allow-none): Location to store the frame
+ *  meta data or %NULL
+ * @error: Location to store a #UcaCameraError error or %NULL
+ *
+ * Copy the next frame for @subscriber into @data.
+ *
+ * Returns: %TRUE on success.
+ * Since: 2.3
+ */
+gboolean
+uca_camera_subscriber_grab (UcaCameraSubscriber *subscriber, gpointer data, UcaFrameInfo *info, GError **error)
+{
+    gpointer buffer;
 
-            Py_END_ALLOW_THREADS
-            PyGILState_Release (state);
-        }
-        else {
-            result = (*klass->readout) (camera, data, index, error);
-        }
-#else
-        result = (*klass->readout) (camera, data, index, error);
-#endif
+    g_return_val_if_fail (subscriber != NULL, FALSE);
+    g_return_val_if_fail (data != NULL, FALSE);
 
-        g_static_mutex_unlock (&access_lock);
-    }
+    buffer = uca_camera_subscriber_borrow (subscriber, info, error);
 
-    g_static_mutex_unlock (&mutex);
+    if (buffer == NULL)
+        return FALSE;
 
-    return result;
+    memcpy (data, buffer, uca_ring_buffer_get_block_size (subscriber->camera->priv->ring_buffer));
+    uca_camera_subscriber_release (subscriber, buffer);
+    return TRUE;
 }
 
 static GParamSpec *
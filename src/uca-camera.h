@@ -19,6 +19,9 @@
 #define __UCA_CAMERA_H
 
 #include <glib-object.h>
+#include <gio/gio.h>
+#include "uca-ring-buffer.h"
+#include "uca-frame.h"
 
 G_BEGIN_DECLS
 
@@ -29,6 +32,9 @@ G_BEGIN_DECLS
 #define UCA_IS_CAMERA_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), UCA_TYPE_CAMERA))
 #define UCA_CAMERA_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), UCA_TYPE_CAMERA, UcaCameraClass))
 
+#define UCA_TYPE_FRAME_FORMAT       (uca_frame_format_get_type())
+#define UCA_TYPE_CAMERA_READOUT_RANGE (uca_camera_readout_range_get_type())
+
 #define UCA_CAMERA_ERROR    uca_camera_error_quark()
 #define UCA_UNIT_QUARK      uca_unit_quark()
 #define UCA_WRITABLE_QUARK  uca_writable_quark()
@@ -45,7 +51,8 @@ typedef enum {
     UCA_CAMERA_ERROR_NOT_IMPLEMENTED,
     UCA_CAMERA_ERROR_WRONG_WRITE_METADATA,
     UCA_CAMERA_ERROR_END_OF_STREAM,
-    UCA_CAMERA_ERROR_TIMEOUT
+    UCA_CAMERA_ERROR_TIMEOUT,
+    UCA_CAMERA_ERROR_INVALID_VALUE
 } UcaCameraError;
 
 typedef enum {
@@ -68,9 +75,26 @@ typedef enum {
     UCA_UNIT_COUNT
 } UcaUnit;
 
+typedef enum {
+    UCA_CAMERA_SUBSCRIBER_LOSSLESS,
+    UCA_CAMERA_SUBSCRIBER_LATEST
+} UcaCameraSubscriberPolicy;
+
+typedef enum {
+    UCA_PIXEL_FORMAT_MONO8,
+    UCA_PIXEL_FORMAT_MONO16,
+    UCA_PIXEL_FORMAT_MONO32,
+    UCA_PIXEL_FORMAT_MONO10_PACKED,
+    UCA_PIXEL_FORMAT_MONO12_PACKED,
+    UCA_PIXEL_FORMAT_MONO14_PACKED
+} UcaPixelFormat;
+
+typedef struct _UcaFrameFormat      UcaFrameFormat;
 typedef struct _UcaCamera           UcaCamera;
 typedef struct _UcaCameraClass      UcaCameraClass;
 typedef struct _UcaCameraPrivate    UcaCameraPrivate;
+typedef struct _UcaCameraSubscriber UcaCameraSubscriber;
+typedef struct _UcaCameraReadoutRange UcaCameraReadoutRange;
 
 enum {
     PROP_0 = 0,
@@ -103,6 +127,18 @@ enum {
 
     PROP_BUFFERED,
     PROP_NUM_BUFFERS,
+    PROP_GRAB_TIMEOUT,
+    PROP_OVERRUN_POLICY,
+    PROP_BUFFER_ALLOC_FLAGS,
+    PROP_BUFFER_NUMA_NODE,
+    PROP_BUFFER_UNPACK,
+    PROP_DISPATCH_THREADS,
+    PROP_DISPATCH_QUEUE_LENGTH,
+    PROP_DISPATCH_ORDERED,
+    PROP_FRAMES_GRABBED,
+    PROP_FRAMES_DROPPED,
+    PROP_FRAMES_OVERRUN,
+    PROP_BYTES_TRANSFERRED,
     N_BASE_PROPERTIES
 };
 
@@ -117,6 +153,138 @@ extern const gchar *uca_camera_props[N_BASE_PROPERTIES];
  */
 typedef void (*UcaCameraGrabFunc) (gpointer data, gpointer user_data);
 
+/**
+ * UcaCameraProgressFunc:
+ * @n_done: Number of frames transferred so far
+ * @n_total: Number of frames to transfer
+ * @user_data: user data passed to the function
+ *
+ * A function receiving progress updates of a long running transfer.
+ *
+ * Since: 2.3
+ */
+typedef void (*UcaCameraProgressFunc) (guint n_done, guint n_total, gpointer user_data);
+
+/**
+ * UcaCameraDispatchStats:
+ * @queue_depth: Number of frames currently queued or in a callback
+ * @max_queue_depth: Highest @queue_depth since recording started
+ * @n_dispatched: Number of frames passed to the grab callback
+ * @n_dropped: Number of frames dropped because the queue was full
+ * @mean_latency: Mean time in seconds from enqueueing a frame until its
+ *  callback returned
+ * @max_latency: Maximum dispatch latency
+ * @mean_callback_time: Mean time in seconds spent in the grab callback
+ * @max_callback_time: Maximum time in seconds spent in the grab callback
+ *
+ * Statistics of the dispatch queue enabled with #UcaCamera:dispatch-threads.
+ *
+ * Since: 2.3
+ */
+typedef struct {
+    guint   queue_depth;
+    guint   max_queue_depth;
+    guint64 n_dispatched;
+    guint64 n_dropped;
+    gdouble mean_latency;
+    gdouble max_latency;
+    gdouble mean_callback_time;
+    gdouble max_callback_time;
+} UcaCameraDispatchStats;
+
+#define UCA_CAMERA_HISTOGRAM_BINS 24
+
+/**
+ * UcaCameraHistogram:
+ * @bins: Bin 0 counts samples of value zero, bin i > 0 counts samples in
+ *  [2^(i-1), 2^i) and the last bin also counts all larger samples
+ * @n_samples: Number of recorded samples
+ * @sum: Sum of all samples
+ * @max: Largest sample
+ *
+ * Logarithmic histogram of a quantity sampled once per frame.
+ *
+ * Since: 2.3
+ */
+typedef struct {
+    guint64 bins[UCA_CAMERA_HISTOGRAM_BINS];
+    guint64 n_samples;
+    guint64 sum;
+    guint64 max;
+} UcaCameraHistogram;
+
+/**
+ * UcaCameraStats:
+ * @n_grabbed: Number of frames transferred from the camera
+ * @n_dropped: Number of frames lost by the camera, i.e. gaps in the hardware
+ *  sequence reported with uca_camera_set_hardware_sequence()
+ * @n_overruns: Number of ring buffer overruns of buffered acquisition
+ * @n_bytes: Number of bytes transferred from the camera
+ * @grab_time: Time in microseconds spent in the grab virtual method
+ * @access_wait_time: Time in microseconds spent waiting for exclusive access
+ *  to the camera before grabbing
+ * @consumer_wait_time: Time in microseconds buffered consumers spent waiting
+ *  for a frame
+ * @fill_level: Number of filled ring buffer blocks after each written frame
+ * @stop_time: Time in microseconds the last uca_camera_stop_recording() took
+ *
+ * Acquisition statistics, see uca_camera_get_stats().
+ *
+ * Since: 2.3
+ */
+typedef struct {
+    guint64 n_grabbed;
+    guint64 n_dropped;
+    guint64 n_overruns;
+    guint64 n_bytes;
+    UcaCameraHistogram grab_time;
+    UcaCameraHistogram access_wait_time;
+    UcaCameraHistogram consumer_wait_time;
+    UcaCameraHistogram fill_level;
+    guint64 stop_time;
+} UcaCameraStats;
+
+struct _UcaFrameFormat {
+    UcaPixelFormat  pixel_format;
+    guint           width;
+    guint           height;
+    guint           bits;
+    guint           bits_per_pixel;
+    guint           bytes_per_pixel;
+    gsize           stride;
+    gsize           padding;
+    gsize           size;
+};
+
+/**
+ * UcaCameraSnapshot:
+ * @roi_x: Value of #UcaCamera:roi-x0
+ * @roi_y: Value of #UcaCamera:roi-y0
+ * @roi_width: Value of #UcaCamera:roi-width
+ * @roi_height: Value of #UcaCamera:roi-height
+ * @sensor_bitdepth: Value of #UcaCamera:sensor-bitdepth
+ * @exposure_time: Value of #UcaCamera:exposure-time
+ * @trigger_source: Value of #UcaCamera:trigger-source
+ * @trigger_type: Value of #UcaCamera:trigger-type
+ * @format: Result of uca_camera_get_frame_format(), @format.size is the
+ *  frame size
+ *
+ * Acquisition settings of a camera, see uca_camera_get_snapshot().
+ *
+ * Since: 2.3
+ */
+typedef struct {
+    guint                   roi_x;
+    guint                   roi_y;
+    guint                   roi_width;
+    guint                   roi_height;
+    guint                   sensor_bitdepth;
+    gdouble                 exposure_time;
+    UcaCameraTriggerSource  trigger_source;
+    UcaCameraTriggerType    trigger_type;
+    UcaFrameFormat          format;
+} UcaCameraSnapshot;
+
 struct _UcaCamera {
     /*< private >*/
     GObject parent;
@@ -144,6 +312,10 @@ struct _UcaCameraClass {
     void (*write)           (UcaCamera *camera, const gchar *name, gpointer data, gsize size, GError **error);
     gboolean (*grab)        (UcaCamera *camera, gpointer data, GError **error);
     gboolean (*readout)     (UcaCamera *camera, gpointer data, guint index, GError **error);
+    guint    (*grab_many)   (UcaCamera *camera, gpointer *buffers, guint n, GError **error);
+    void     (*get_frame_format) (UcaCamera *camera, UcaFrameFormat *format);
+    gboolean (*set_properties) (UcaCamera *camera, guint n_properties, GParamSpec **pspecs, const GValue *values, GError **error);
+    gboolean (*grab_cancellable) (UcaCamera *camera, gpointer data, GCancellable *cancellable, GError **error);
 };
 
 UcaCamera * uca_camera_new              (const gchar        *type,
@@ -152,6 +324,12 @@ gboolean    uca_camera_parse_arg_props  (UcaCamera          *camera,
                                          gchar             **argv,
                                          guint               argc,
                                          GError            **error);
+gboolean    uca_camera_set_properties_batch
+                                        (UcaCamera          *camera,
+                                         guint               n_properties,
+                                         const gchar       **names,
+                                         const GValue       *values,
+                                         GError            **error);
 void        uca_camera_start_recording  (UcaCamera          *camera,
                                          GError            **error);
 void        uca_camera_stop_recording   (UcaCamera          *camera,
@@ -172,14 +350,114 @@ gboolean    uca_camera_grab             (UcaCamera          *camera,
                                          gpointer            data,
                                          GError            **error)
                                         __attribute__((nonnull (2)));
+gboolean    uca_camera_grab_with_info   (UcaCamera          *camera,
+                                         gpointer            data,
+                                         UcaFrameInfo       *info,
+                                         GError            **error)
+                                        __attribute__((nonnull (2)));
+gboolean    uca_camera_grab_full        (UcaCamera          *camera,
+                                         gpointer            data,
+                                         UcaFrameInfo       *info,
+                                         GCancellable       *cancellable,
+                                         GError            **error)
+                                        __attribute__((nonnull (2)));
+UcaFrame *  uca_camera_grab_frame       (UcaCamera          *camera,
+                                         GError            **error);
+gint        uca_camera_get_frame_fd     (UcaCamera          *camera,
+                                         GError            **error);
+GSource *   uca_camera_create_frame_source
+                                        (UcaCamera          *camera,
+                                         GError            **error);
+void        uca_camera_grab_async       (UcaCamera          *camera,
+                                         gpointer            data,
+                                         GCancellable       *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer            user_data);
+gboolean    uca_camera_grab_finish      (UcaCamera          *camera,
+                                         GAsyncResult       *result,
+                                         UcaFrameInfo       *info,
+                                         GError            **error);
+guint       uca_camera_grab_many        (UcaCamera          *camera,
+                                         gpointer           *buffers,
+                                         guint               n,
+                                         UcaFrameInfo       *infos,
+                                         GError            **error);
+guint       uca_camera_grab_stack       (UcaCamera          *camera,
+                                         gpointer            data,
+                                         guint               n,
+                                         UcaFrameInfo       *infos,
+                                         GError            **error)
+                                        __attribute__((nonnull (2)));
+gsize       uca_camera_get_frame_size   (UcaCamera          *camera);
+void        uca_camera_get_frame_format (UcaCamera          *camera,
+                                         UcaFrameFormat     *format);
+void        uca_camera_get_snapshot     (UcaCamera          *camera,
+                                         UcaCameraSnapshot  *snapshot);
+gpointer    uca_camera_grab_borrow      (UcaCamera          *camera,
+                                         UcaFrameInfo       *info,
+                                         GError            **error);
+void        uca_camera_frame_release    (UcaCamera          *camera,
+                                         gpointer            data);
+UcaCameraSubscriber *
+            uca_camera_subscribe        (UcaCamera          *camera,
+                                         UcaCameraSubscriberPolicy policy);
+void        uca_camera_unsubscribe      (UcaCameraSubscriber *subscriber);
+gpointer    uca_camera_subscriber_borrow
+                                        (UcaCameraSubscriber *subscriber,
+                                         UcaFrameInfo       *info,
+                                         GError            **error);
+void        uca_camera_subscriber_release
+                                        (UcaCameraSubscriber *subscriber,
+                                         gpointer            data);
+gboolean    uca_camera_subscriber_grab  (UcaCameraSubscriber *subscriber,
+                                         gpointer            data,
+                                         UcaFrameInfo       *info,
+                                         GError            **error)
+                                        __attribute__((nonnull (2)));
 gboolean    uca_camera_readout          (UcaCamera          *camera,
                                          gpointer            data,
                                          guint               index,
                                          GError            **error)
                                         __attribute__((nonnull (2)));
+void        uca_camera_readout_async    (UcaCamera          *camera,
+                                         gpointer            data,
+                                         guint               index,
+                                         GCancellable       *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer            user_data);
+gboolean    uca_camera_readout_finish   (UcaCamera          *camera,
+                                         GAsyncResult       *result,
+                                         GError            **error);
+UcaCameraReadoutRange *
+            uca_camera_readout_range    (UcaCamera          *camera,
+                                         guint               first,
+                                         guint               count,
+                                         GCancellable       *cancellable,
+                                         UcaCameraProgressFunc progress,
+                                         gpointer            user_data,
+                                         GError            **error);
+gboolean    uca_camera_readout_range_grab
+                                        (UcaCameraReadoutRange *range,
+                                         gpointer            data,
+                                         UcaFrameInfo       *info,
+                                         GError            **error)
+                                        __attribute__((nonnull (2)));
+UcaCameraReadoutRange *
+            uca_camera_readout_range_ref
+                                        (UcaCameraReadoutRange *range);
+void        uca_camera_readout_range_free
+                                        (UcaCameraReadoutRange *range);
+void        uca_camera_set_hardware_sequence
+                                        (UcaCamera          *camera,
+                                         guint64             sequence);
 void        uca_camera_set_grab_func    (UcaCamera          *camera,
                                          UcaCameraGrabFunc   func,
                                          gpointer            user_data);
+void        uca_camera_get_dispatch_stats
+                                        (UcaCamera          *camera,
+                                         UcaCameraDispatchStats *stats);
+void        uca_camera_get_stats        (UcaCamera          *camera,
+                                         UcaCameraStats     *stats);
 void        uca_camera_register_unit    (UcaCamera          *camera,
                                          const gchar        *prop_name,
                                          UcaUnit             unit);
@@ -196,7 +474,25 @@ gboolean    uca_camera_is_writable_during_acquisition
                                          const gchar        *prop_name);
 
 
+void        uca_frame_format_init       (UcaFrameFormat     *format,
+                                         UcaPixelFormat      pixel_format,
+                                         guint               width,
+                                         guint               height,
+                                         guint               bits,
+                                         gsize               padding);
+UcaFrameFormat *
+            uca_frame_format_copy       (const UcaFrameFormat *format);
+void        uca_frame_format_free       (UcaFrameFormat     *format);
+UcaPixelFormat
+            uca_pixel_format_from_bitdepth
+                                        (guint               bits);
+guint       uca_pixel_format_get_bits_per_pixel
+                                        (UcaPixelFormat      pixel_format);
+gboolean    uca_pixel_format_is_packed  (UcaPixelFormat      pixel_format);
+
 GType uca_camera_get_type(void);
+GType uca_frame_format_get_type(void);
+GType uca_camera_readout_range_get_type(void);
 
 G_END_DECLS
 
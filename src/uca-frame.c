@@ -0,0 +1,318 @@
+/* Copyright (C) 2026 The libuca contributors
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+   details.
+
+   You should have received a copy of the GNU Lesser General Public License along
+   with this library; if not, write to the Free Software Foundation, Inc., 51
+   Franklin St, Fifth Floor, Boston, MA 02110, USA */
+
+/**
+ * SECTION:uca-frame
+ * @Short_description: Reference counted frame buffers
+ * @Title: UcaFrame
+ *
+ * A #UcaFrame holds the pixel data and the #UcaFrameInfo of a single frame.
+ * Frames are handed out by a #UcaFramePool and go back to it when the last
+ * reference is dropped, so that steady state acquisition neither allocates
+ * nor page faults. This makes them suitable for language bindings that would
+ * otherwise allocate a new array for every frame.
+ */
+
+#include <string.h>
+#include "uca-frame.h"
+
+G_DEFINE_BOXED_TYPE(UcaFrame, uca_frame, uca_frame_ref, uca_frame_unref)
+G_DEFINE_BOXED_TYPE(UcaFramePool, uca_frame_pool, uca_frame_pool_ref, uca_frame_pool_unref)
+
+struct _UcaFrame {
+    gint ref_count;
+    UcaFramePool *pool;
+    gpointer data;
+    gsize size;
+    UcaFrameInfo info;
+};
+
+struct _UcaFramePool {
+    gint ref_count;
+    GMutex lock;
+    GQueue idle;
+    guint max_idle;
+    gsize frame_size;
+};
+
+static UcaFrame *
+frame_new (gsize size)
+{
+    UcaFrame *frame;
+
+    frame = g_slice_new0 (UcaFrame);
+    frame->size = size;
+
+    /* Touch every page now rather than in the first grab */
+    frame->data = g_malloc (size);
+    memset (frame->data, 0, size);
+
+    return frame;
+}
+
+static void
+frame_free (UcaFrame *frame)
+{
+    g_free (frame->data);
+    g_slice_free (UcaFrame, frame);
+}
+
+/**
+ * uca_frame_pool_new:
+ * @frame_size: Size of each frame in bytes
+ * @n_preallocated: Number of frames to allocate up front
+ *
+ * Create a pool of frames of @frame_size bytes. The pool grows if more frames
+ * are in use than were preallocated. Released frames beyond @n_preallocated
+ * idle ones are freed, so that a burst does not keep its memory.
+ *
+ * Returns: (transfer full): A new #UcaFramePool
+ * Since: 2.3
+ */
+UcaFramePool *
+uca_frame_pool_new (gsize frame_size, guint n_preallocated)
+{
+    UcaFramePool *pool;
+
+    g_return_val_if_fail (frame_size > 0, NULL);
+
+    pool = g_slice_new0 (UcaFramePool);
+    pool->ref_count = 1;
+    pool->frame_size = frame_size;
+    pool->max_idle = MAX (n_preallocated, 1);
+    g_mutex_init (&pool->lock);
+    g_queue_init (&pool->idle);
+
+    for (guint i = 0; i < n_preallocated; i++)
+        g_queue_push_tail (&pool->idle, frame_new (frame_size));
+
+    return pool;
+}
+
+/**
+ * uca_frame_pool_ref:
+ * @pool: A #UcaFramePool
+ *
+ * Returns: (transfer full): @pool
+ * Since: 2.3
+ */
+UcaFramePool *
+uca_frame_pool_ref (UcaFramePool *pool)
+{
+    g_return_val_if_fail (pool != NULL, NULL);
+    g_atomic_int_inc (&pool->ref_count);
+    return pool;
+}
+
+/**
+ * uca_frame_pool_unref:
+ * @pool: A #UcaFramePool
+ *
+ * Drop a reference of @pool. Frames still in use keep the pool alive.
+ *
+ * Since: 2.3
+ */
+void
+uca_frame_pool_unref (UcaFramePool *pool)
+{
+    g_return_if_fail (pool != NULL);
+
+    if (g_atomic_int_dec_and_test (&pool->ref_count)) {
+        UcaFrame *frame;
+
+        while ((frame = g_queue_pop_head (&pool->idle)) != NULL)
+            frame_free (frame);
+
+        g_mutex_clear (&pool->lock);
+        g_slice_free (UcaFramePool, pool);
+    }
+}
+
+/**
+ * uca_frame_pool_get_frame_size:
+ * @pool: A #UcaFramePool
+ *
+ * Returns: Size of the frames of @pool in bytes.
+ * Since: 2.3
+ */
+gsize
+uca_frame_pool_get_frame_size (UcaFramePool *pool)
+{
+    g_return_val_if_fail (pool != NULL, 0);
+    return pool->frame_size;
+}
+
+/**
+ * uca_frame_pool_get_num_idle:
+ * @pool: A #UcaFramePool
+ *
+ * Returns: Number of frames that are ready to be handed out without
+ *  allocation.
+ * Since: 2.3
+ */
+guint
+uca_frame_pool_get_num_idle (UcaFramePool *pool)
+{
+    guint n_idle;
+
+    g_return_val_if_fail (pool != NULL, 0);
+
+    g_mutex_lock (&pool->lock);
+    n_idle = g_queue_get_length (&pool->idle);
+    g_mutex_unlock (&pool->lock);
+
+    return n_idle;
+}
+
+/**
+ * uca_frame_pool_acquire:
+ * @pool: A #UcaFramePool
+ *
+ * Take an idle frame from @pool or allocate a new one if none is left. The
+ * contents of the returned frame are undefined.
+ *
+ * Returns: (transfer full): A #UcaFrame, release it with uca_frame_unref()
+ * Since: 2.3
+ */
+UcaFrame *
+uca_frame_pool_acquire (UcaFramePool *pool)
+{
+    UcaFrame *frame;
+
+    g_return_val_if_fail (pool != NULL, NULL);
+
+    g_mutex_lock (&pool->lock);
+    frame = g_queue_pop_head (&pool->idle);
+    g_mutex_unlock (&pool->lock);
+
+    if (frame == NULL)
+        frame = frame_new (pool->frame_size);
+
+    /* Only frames in use hold the pool, idle ones would form a cycle */
+    frame->ref_count = 1;
+    frame->pool = uca_frame_pool_ref (pool);
+
+    return frame;
+}
+
+/**
+ * uca_frame_ref:
+ * @frame: A #UcaFrame
+ *
+ * Returns: (transfer full): @frame
+ * Since: 2.3
+ */
+UcaFrame *
+uca_frame_ref (UcaFrame *frame)
+{
+    g_return_val_if_fail (frame != NULL, NULL);
+    g_atomic_int_inc (&frame->ref_count);
+    return frame;
+}
+
+/**
+ * uca_frame_unref:
+ * @frame: A #UcaFrame
+ *
+ * Drop a reference of @frame. The last reference returns it to its pool or
+ * frees it if the pool already holds enough idle frames. This function can be
+ * called from any thread.
+ *
+ * Since: 2.3
+ */
+void
+uca_frame_unref (UcaFrame *frame)
+{
+    UcaFramePool *pool;
+
+    g_return_if_fail (frame != NULL);
+
+    if (!g_atomic_int_dec_and_test (&frame->ref_count))
+        return;
+
+    pool = frame->pool;
+    frame->pool = NULL;
+
+    g_mutex_lock (&pool->lock);
+
+    if (g_queue_get_length (&pool->idle) < pool->max_idle) {
+        g_queue_push_head (&pool->idle, frame);
+        frame = NULL;
+    }
+
+    g_mutex_unlock (&pool->lock);
+
+    if (frame != NULL)
+        frame_free (frame);
+
+    uca_frame_pool_unref (pool);
+}
+
+/**
+ * uca_frame_get_data:
+ * @frame: A #UcaFrame
+ * @size: (out) (allow-none): Location to store the size in bytes or %NULL
+ *
+ * Returns: (transfer none) (type gulong): Address of the pixel data of
+ *  @frame, valid as long as a reference is held. Bindings can wrap it without
+ *  copying, e.g. with numpy and ctypes.
+ * Since: 2.3
+ */
+gpointer
+uca_frame_get_data (UcaFrame *frame, gsize *size)
+{
+    g_return_val_if_fail (frame != NULL, NULL);
+
+    if (size != NULL)
+        *size = frame->size;
+
+    return frame->data;
+}
+
+/**
+ * uca_frame_get_info:
+ * @frame: A #UcaFrame
+ *
+ * Returns: (transfer none): The meta data of @frame
+ * Since: 2.3
+ */
+UcaFrameInfo *
+uca_frame_get_info (UcaFrame *frame)
+{
+    g_return_val_if_fail (frame != NULL, NULL);
+    return &frame->info;
+}
+
+/**
+ * uca_frame_get_bytes:
+ * @frame: A #UcaFrame
+ *
+ * Wrap the pixel data of @frame without copying. The #GBytes holds a
+ * reference of @frame, so the frame goes back to its pool only after both
+ * are released.
+ *
+ * Returns: (transfer full): A #GBytes viewing the data of @frame
+ * Since: 2.3
+ */
+GBytes *
+uca_frame_get_bytes (UcaFrame *frame)
+{
+    g_return_val_if_fail (frame != NULL, NULL);
+
+    return g_bytes_new_with_free_func (frame->data, frame->size,
+                                       (GDestroyNotify) uca_frame_unref,
+                                       uca_frame_ref (frame));
+}
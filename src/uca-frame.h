@@ -0,0 +1,35 @@
+#ifndef UCA_FRAME_H
+#define UCA_FRAME_H
+
+#include <glib-object.h>
+#include "uca-ring-buffer.h"
+
+G_BEGIN_DECLS
+
+#define UCA_TYPE_FRAME          (uca_frame_get_type())
+#define UCA_TYPE_FRAME_POOL     (uca_frame_pool_get_type())
+
+typedef struct _UcaFrame        UcaFrame;
+typedef struct _UcaFramePool    UcaFramePool;
+
+UcaFramePool *  uca_frame_pool_new              (gsize           frame_size,
+                                                 guint           n_preallocated);
+UcaFramePool *  uca_frame_pool_ref              (UcaFramePool   *pool);
+void            uca_frame_pool_unref            (UcaFramePool   *pool);
+gsize           uca_frame_pool_get_frame_size   (UcaFramePool   *pool);
+guint           uca_frame_pool_get_num_idle     (UcaFramePool   *pool);
+UcaFrame *      uca_frame_pool_acquire          (UcaFramePool   *pool);
+
+UcaFrame *      uca_frame_ref                   (UcaFrame       *frame);
+void            uca_frame_unref                 (UcaFrame       *frame);
+gpointer        uca_frame_get_data              (UcaFrame       *frame,
+                                                 gsize          *size);
+UcaFrameInfo *  uca_frame_get_info              (UcaFrame       *frame);
+GBytes *        uca_frame_get_bytes             (UcaFrame       *frame);
+
+GType uca_frame_get_type (void);
+GType uca_frame_pool_get_type (void);
+
+G_END_DECLS
+
+#endif
@@ -15,32 +15,160 @@
    with this library; if not, write to the Free Software Foundation, Inc., 51
    Franklin St, Fifth Floor, Boston, MA 02110, USA */
 
+/* Needed for MAP_ANONYMOUS, madvise() and syscall() with -std=c99 */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "config.h"
+
+#include <errno.h>
 #include <math.h>
+#include <string.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#include <gio/gio.h>
 #include "uca-ring-buffer.h"
+#include "uca-enums.h"
 
 #define UCA_RING_BUFFER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), UCA_TYPE_RING_BUFFER, UcaRingBufferPrivate))
 
-G_DEFINE_TYPE(UcaRingBuffer, uca_ring_buffer, G_TYPE_OBJECT)
+static void uca_ring_buffer_initable_iface_init (GInitableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (UcaRingBuffer, uca_ring_buffer, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
+                                                uca_ring_buffer_initable_iface_init))
+G_DEFINE_BOXED_TYPE(UcaFrameInfo, uca_frame_info, uca_frame_info_copy, uca_frame_info_free)
+
+/**
+ * UcaFrameInfo:
+ * @sequence: Number of the frame since recording started, counting frames
+ *      that were dropped later on
+ * @hw_sequence: Frame number reported by the camera or @sequence if the
+ *      camera does not provide one
+ * @grab_start: Monotonic time in microseconds when grabbing started
+ * @grab_end: Monotonic time in microseconds when grabbing finished
+ * @n_dropped: Number of frames lost between the previously delivered frame
+ *      and this one
+ *
+ * Meta data that is recorded alongside each frame.
+ *
+ * Since: 2.3
+ */
+
+/**
+ * UcaRingBufferOverrunPolicy:
+ * @UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK: uca_ring_buffer_get_write_pointer()
+ *      returns %NULL until the reader made room
+ * @UCA_RING_BUFFER_OVERRUN_POLICY_DROP_NEWEST: The new block is written to a
+ *      scratch area and discarded
+ * @UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST: The oldest unread block is
+ *      discarded and overwritten
+ *
+ * Determines what happens when the writer catches up with the reader.
+ */
+
+/**
+ * UcaRingBufferAllocFlags:
+ * @UCA_RING_BUFFER_ALLOC_DEFAULT: Plain page-aligned anonymous memory
+ * @UCA_RING_BUFFER_ALLOC_TRANSPARENT_HUGEPAGES: Advise the kernel to back the
+ *      blocks with transparent huge pages
+ * @UCA_RING_BUFFER_ALLOC_HUGEPAGES: Allocate from the explicit huge page pool,
+ *      falls back to regular pages if the pool is exhausted
+ * @UCA_RING_BUFFER_ALLOC_LOCK: Lock the blocks into memory with mlock()
+ * @UCA_RING_BUFFER_ALLOC_POPULATE: Fault in all pages at construction instead
+ *      of during the first acquisition
+ *
+ * How the memory of a #UcaRingBuffer is allocated. The flags only have an
+ * effect on systems with mmap(), elsewhere the blocks are allocated with
+ * g_malloc().
+ *
+ * Since: 2.3
+ */
 
+/*
+ * The buffer is a single-producer/single-consumer ring. Both indices run
+ * freely and wrap at a multiple of the block count, so that the number of
+ * filled blocks is always their difference and a full ring can be told apart
+ * from an empty one. The write index is only ever modified by the producer.
+ * The read index is advanced by the consumer and, when dropping the oldest
+ * block, by the producer, hence it is only updated with compare-and-exchange.
+ */
 struct _UcaRingBufferPrivate {
     guchar  *data;
+    gint    *pinned;
+    UcaFrameInfo *info;
     gsize    block_size;
     guint    n_blocks_total;
-    guint    write_index;
-    guint    read_index;
-    guint    read;
-    guint    written;
+    guint    mask;
+    guint    wrap;
+    gboolean is_pow2;
+    gint     write_index;
+    gint     read_index;
+    gint     n_overruns;
+    gboolean write_to_scratch;
+    gboolean blocked;
+    UcaRingBufferOverrunPolicy policy;
+    UcaRingBufferAllocFlags alloc_flags;
+    gint     numa_node;
+    gsize    mapped_size;
+    gsize    page_size;
+    gchar   *backing_file;
+    gint     fd;
+    GError  *alloc_error;
 };
 
 enum {
     PROP_0,
     PROP_BLOCK_SIZE,
     PROP_NUM_BLOCKS,
+    PROP_OVERRUN_POLICY,
+    PROP_ALLOC_FLAGS,
+    PROP_NUMA_NODE,
+    PROP_BACKING_FILE,
     N_PROPERTIES
 };
 
 static GParamSpec *properties[N_PROPERTIES] = { NULL, };
 
+/*
+ * Amount of written data of a file-backed buffer that may stay in memory
+ * before it is written back and evicted from the page cache.
+ */
+#define WRITE_BEHIND_BYTES  (256 * 1024 * 1024)
+
+static void write_behind (UcaRingBufferPrivate *priv, guint slot);
+
+static inline guint
+get_slot (UcaRingBufferPrivate *priv, guint index)
+{
+    return priv->is_pow2 ? index & priv->mask : index % priv->n_blocks_total;
+}
+
+static inline guint
+next_index (UcaRingBufferPrivate *priv, guint index)
+{
+    return index + 1 < priv->wrap ? index + 1 : 0;
+}
+
+static inline guint
+get_distance (UcaRingBufferPrivate *priv, guint write_index, guint read_index)
+{
+    return write_index >= read_index ? write_index - read_index : write_index + priv->wrap - read_index;
+}
+
+static inline guchar *
+get_block (UcaRingBufferPrivate *priv, guint slot)
+{
+    return priv->data + slot * priv->block_size;
+}
+
 UcaRingBuffer *
 uca_ring_buffer_new (gsize block_size,
                      guint n_blocks)
@@ -54,13 +182,96 @@ uca_ring_buffer_new (gsize block_size,
     return buffer;
 }
 
+/**
+ * uca_ring_buffer_new_mapped:
+ * @filename: Path of the file that backs the blocks
+ * @block_size: Number of bytes per block
+ * @n_blocks: Number of blocks
+ * @error: Location to store a #GFileError or %NULL
+ *
+ * Create a new ring buffer whose blocks live in a shared memory mapping of
+ * @filename instead of anonymous memory. The file is created or truncated to
+ * hold all blocks, which may by far exceed the physical memory. Written
+ * blocks are handed to the kernel for write-back right away and dropped from
+ * memory a while later, so that the writer keeps running at memory speed as
+ * long as the disk sustains the average data rate. The file is kept after the
+ * buffer is destroyed.
+ *
+ * This is equivalent to g_initable_new() with #UcaRingBuffer:backing-file.
+ * Objects with a backing file must be initialized with g_initable_init(),
+ * which fails if the file cannot be mapped.
+ *
+ * Return value: (transfer full): A new #UcaRingBuffer or %NULL on error
+ * Since: 2.3
+ */
+UcaRingBuffer *
+uca_ring_buffer_new_mapped (const gchar *filename,
+                            gsize block_size,
+                            guint n_blocks,
+                            GError **error)
+{
+    UcaRingBuffer *buffer;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+
+    buffer = g_initable_new (UCA_TYPE_RING_BUFFER, NULL, error,
+                             "block-size", (guint64) block_size,
+                             "num-blocks", n_blocks,
+                             "backing-file", filename,
+                             NULL);
+    return buffer;
+}
+
+/**
+ * uca_ring_buffer_new_full:
+ * @block_size: Number of bytes per block
+ * @n_blocks: Number of blocks
+ * @flags: #UcaRingBufferAllocFlags for the block memory
+ * @numa_node: NUMA node to bind the block memory to or -1 to use the default
+ *      placement of the allocating thread
+ *
+ * Create a new ring buffer and allocate its memory according to @flags.
+ *
+ * Return value: (transfer full): A new #UcaRingBuffer
+ * Since: 2.3
+ */
+UcaRingBuffer *
+uca_ring_buffer_new_full (gsize block_size,
+                          guint n_blocks,
+                          UcaRingBufferAllocFlags flags,
+                          gint numa_node)
+{
+    UcaRingBuffer *buffer;
+
+    buffer = g_object_new (UCA_TYPE_RING_BUFFER,
+                           "block-size", (guint64) block_size,
+                           "num-blocks", n_blocks,
+                           "alloc-flags", flags,
+                           "numa-node", numa_node,
+                           NULL);
+    return buffer;
+}
+
+/**
+ * uca_ring_buffer_reset:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Discard all blocks and reset the overrun counter. Must not be called while
+ * reader or writer are active.
+ */
 void
 uca_ring_buffer_reset (UcaRingBuffer *buffer)
 {
+    UcaRingBufferPrivate *priv;
+
     g_return_if_fail (UCA_IS_RING_BUFFER (buffer));
+    priv = buffer->priv;
 
-    buffer->priv->write_index = 0;
-    buffer->priv->read_index = 0;
+    priv->write_to_scratch = FALSE;
+    priv->blocked = FALSE;
+    g_atomic_int_set (&priv->n_overruns, 0);
+    g_atomic_int_set (&priv->read_index, 0);
+    g_atomic_int_set (&priv->write_index, 0);
 }
 
 gsize
@@ -73,8 +284,11 @@ uca_ring_buffer_get_block_size (UcaRingBuffer *buffer)
 gboolean
 uca_ring_buffer_available (UcaRingBuffer *buffer)
 {
+    UcaRingBufferPrivate *priv;
+
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), FALSE);
-    return buffer->priv->read_index < buffer->priv->write_index;
+    priv = buffer->priv;
+    return g_atomic_int_get (&priv->read_index) != g_atomic_int_get (&priv->write_index);
 }
 
 /**
@@ -90,22 +304,166 @@ gpointer
 uca_ring_buffer_get_read_pointer (UcaRingBuffer *buffer)
 {
     UcaRingBufferPrivate *priv;
-    gpointer data;
+    guint index;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
+    g_return_val_if_fail (uca_ring_buffer_available (buffer), NULL);
+    priv = buffer->priv;
+
+    /* The writer may drop the oldest block concurrently, retry in that case */
+    do {
+        index = (guint) g_atomic_int_get (&priv->read_index);
+    } while (!g_atomic_int_compare_and_exchange (&priv->read_index, index, next_index (priv, index)));
+
+    return get_block (priv, get_slot (priv, index));
+}
+
+/**
+ * uca_ring_buffer_borrow_read_pointer:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Get pointer to current read location like uca_ring_buffer_get_read_pointer()
+ * but pin the block so that uca_ring_buffer_is_pinned() reports it as in use
+ * until it is handed back with uca_ring_buffer_release_pointer().
+ *
+ * Return value: (transfer none): Pointer to current read location
+ * Since: 2.3
+ */
+gpointer
+uca_ring_buffer_borrow_read_pointer (UcaRingBuffer *buffer)
+{
+    UcaRingBufferPrivate *priv;
+    guint index;
+    guint slot;
 
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
+    g_return_val_if_fail (uca_ring_buffer_available (buffer), NULL);
     priv = buffer->priv;
 
-    g_return_val_if_fail (priv->read_index != priv->write_index, NULL);
-    data = priv->data + (priv->read_index % priv->n_blocks_total) * priv->block_size;
-    priv->read_index++;
-    return data;
+    /*
+     * Pin before claiming the block, so that a writer that already decided to
+     * overwrite it either sees the pin or makes our claim fail.
+     */
+    while (1) {
+        index = (guint) g_atomic_int_get (&priv->read_index);
+        slot = get_slot (priv, index);
+        g_atomic_int_inc (&priv->pinned[slot]);
+
+        if (g_atomic_int_compare_and_exchange (&priv->read_index, index, next_index (priv, index)))
+            break;
+
+        g_atomic_int_add (&priv->pinned[slot], -1);
+    }
+
+    return get_block (priv, slot);
+}
+
+static guint
+get_block_index (UcaRingBufferPrivate *priv, gpointer data)
+{
+    return (guint) (((guchar *) data - priv->data) / priv->block_size);
+}
+
+/**
+ * uca_ring_buffer_pin_pointer:
+ * @buffer: A #UcaRingBuffer object
+ * @data: Pointer to a written block of @buffer
+ *
+ * Pin an additional reference on the block pointed to by @data, so that the
+ * writer does not overwrite it until uca_ring_buffer_release_pointer() is
+ * called. This allows several readers to share one block.
+ *
+ * Since: 2.3
+ */
+void
+uca_ring_buffer_pin_pointer (UcaRingBuffer *buffer,
+                             gpointer data)
+{
+    UcaRingBufferPrivate *priv;
+    guint index;
+
+    g_return_if_fail (UCA_IS_RING_BUFFER (buffer));
+    priv = buffer->priv;
+
+    index = get_block_index (priv, data);
+    g_return_if_fail (index < priv->n_blocks_total);
+
+    g_atomic_int_inc (&priv->pinned[index]);
+}
+
+/**
+ * uca_ring_buffer_release_pointer:
+ * @buffer: A #UcaRingBuffer object
+ * @data: Pointer returned by uca_ring_buffer_borrow_read_pointer()
+ *
+ * Unpin a block that was previously borrowed.
+ *
+ * Since: 2.3
+ */
+void
+uca_ring_buffer_release_pointer (UcaRingBuffer *buffer,
+                                 gpointer data)
+{
+    UcaRingBufferPrivate *priv;
+    guint index;
+
+    g_return_if_fail (UCA_IS_RING_BUFFER (buffer));
+    priv = buffer->priv;
+
+    index = get_block_index (priv, data);
+    g_return_if_fail (index < priv->n_blocks_total);
+    g_return_if_fail (g_atomic_int_get (&priv->pinned[index]) > 0);
+
+    g_atomic_int_add (&priv->pinned[index], -1);
+}
+
+/**
+ * uca_ring_buffer_is_pinned:
+ * @buffer: A #UcaRingBuffer object
+ * @data: Pointer to a block of @buffer
+ *
+ * Check if the block pointed to by @data is still borrowed and thus must not
+ * be written.
+ *
+ * Return value: %TRUE if the block is borrowed.
+ * Since: 2.3
+ */
+gboolean
+uca_ring_buffer_is_pinned (UcaRingBuffer *buffer,
+                           gpointer data)
+{
+    UcaRingBufferPrivate *priv;
+    guint index;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), FALSE);
+    priv = buffer->priv;
+
+    index = get_block_index (priv, data);
+
+    /* The scratch block is never handed out to readers */
+    if (index == priv->n_blocks_total)
+        return FALSE;
+
+    g_return_val_if_fail (index < priv->n_blocks_total, FALSE);
+
+    return g_atomic_int_get (&priv->pinned[index]) > 0;
+}
+
+static void
+count_overrun (UcaRingBufferPrivate *priv)
+{
+    g_atomic_int_inc (&priv->n_overruns);
 }
 
 /**
  * uca_ring_buffer_get_write_pointer:
  * @buffer: A #UcaRingBuffer object
  *
- * Get pointer to current write location.
+ * Get pointer to current write location. If the ring is full or the block
+ * is still borrowed, the #UcaRingBuffer:overrun-policy decides what happens:
+ * either %NULL is returned and the writer has to try again later, a scratch
+ * block is returned whose contents are discarded by
+ * uca_ring_buffer_write_advance() or the oldest block is given up.
  *
  * Return value: (transfer none): Pointer to current write location
  */
@@ -113,21 +471,106 @@ gpointer
 uca_ring_buffer_get_write_pointer (UcaRingBuffer *buffer)
 {
     UcaRingBufferPrivate *priv;
-    gpointer data;
+    guint write_index;
+    guint read_index;
+    guint slot;
 
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
 
     priv = buffer->priv;
-    data = priv->data + (priv->write_index % priv->n_blocks_total) * priv->block_size;
+    write_index = (guint) g_atomic_int_get (&priv->write_index);
+    read_index = (guint) g_atomic_int_get (&priv->read_index);
+    slot = get_slot (priv, write_index);
+
+    if (get_distance (priv, write_index, read_index) == priv->n_blocks_total) {
+        switch (priv->policy) {
+            case UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK:
+                goto block;
+
+            case UCA_RING_BUFFER_OVERRUN_POLICY_DROP_NEWEST:
+                goto scratch;
+
+            case UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST:
+                /* If this fails, the reader just consumed the oldest block */
+                if (g_atomic_int_compare_and_exchange (&priv->read_index, read_index, next_index (priv, read_index)))
+                    count_overrun (priv);
+                break;
+        }
+    }
+
+    if (g_atomic_int_get (&priv->pinned[slot]) > 0) {
+        if (priv->policy == UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK)
+            goto block;
+
+        goto scratch;
+    }
+
+    priv->blocked = FALSE;
+    priv->write_to_scratch = FALSE;
+    return get_block (priv, slot);
+
+block:
+    /* Count a blocked write only once, no matter how often it is retried */
+    if (!priv->blocked) {
+        priv->blocked = TRUE;
+        count_overrun (priv);
+    }
 
-    return data;
+    return NULL;
+
+scratch:
+    if (!priv->write_to_scratch) {
+        priv->write_to_scratch = TRUE;
+        count_overrun (priv);
+    }
+
+    return get_block (priv, priv->n_blocks_total);
 }
 
-void
+/**
+ * uca_ring_buffer_write_advance:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Publish the block returned by uca_ring_buffer_get_write_pointer() to the
+ * reader. If that was the scratch block, nothing is published.
+ *
+ * Return value: %TRUE if a block was published, %FALSE if the scratch block
+ * was discarded.
+ */
+gboolean
 uca_ring_buffer_write_advance (UcaRingBuffer *buffer)
 {
-    g_return_if_fail (UCA_IS_RING_BUFFER (buffer));
-    buffer->priv->write_index++;
+    UcaRingBufferPrivate *priv;
+    guint write_index;
+    guint read_index;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), FALSE);
+    priv = buffer->priv;
+
+    if (priv->write_to_scratch) {
+        priv->write_to_scratch = FALSE;
+        return FALSE;
+    }
+
+    write_index = (guint) g_atomic_int_get (&priv->write_index);
+    read_index = (guint) g_atomic_int_get (&priv->read_index);
+
+    if (priv->fd >= 0)
+        write_behind (priv, get_slot (priv, write_index));
+
+    /*
+     * Without a preceding uca_ring_buffer_get_write_pointer() the ring may
+     * still be full. Make room, the indices must never be more than a ring
+     * apart.
+     */
+    if (get_distance (priv, write_index, read_index) == priv->n_blocks_total) {
+        if (g_atomic_int_compare_and_exchange (&priv->read_index, read_index, next_index (priv, read_index)))
+            count_overrun (priv);
+    }
+
+    priv->blocked = FALSE;
+    g_atomic_int_set (&priv->write_index, next_index (priv, write_index));
+    return TRUE;
 }
 
 /**
@@ -144,7 +587,7 @@ uca_ring_buffer_peek_pointer (UcaRingBuffer *buffer)
     UcaRingBufferPrivate *priv;
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
     priv = buffer->priv;
-    return ((guint8 *) priv->data) + ((priv->write_index % priv->n_blocks_total) * priv->block_size);
+    return get_block (priv, get_slot (priv, (guint) g_atomic_int_get (&priv->write_index)));
 }
 
 /**
@@ -152,7 +595,8 @@ uca_ring_buffer_peek_pointer (UcaRingBuffer *buffer)
  * @buffer: A #UcaRingBuffer object
  * @index: Block index of queried pointer
  *
- * Get pointer to read location identified by @index.
+ * Get pointer to read location identified by @index, i.e. @index 0 is the
+ * oldest unread block.
  *
  * Return value: (transfer none): Pointer to indexed read location
  */
@@ -161,11 +605,22 @@ uca_ring_buffer_get_pointer (UcaRingBuffer *buffer,
                              guint          index)
 {
     UcaRingBufferPrivate *priv;
+    guint slot;
+
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
     priv = buffer->priv;
-    return ((guint8 *) priv->data) + (((priv->read_index + index) % priv->n_blocks_total) * priv->block_size);
+    slot = get_slot (priv, (guint) g_atomic_int_get (&priv->read_index));
+    return get_block (priv, (slot + index) % priv->n_blocks_total);
 }
 
+/**
+ * uca_ring_buffer_get_num_blocks:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Get the number of written but not yet read blocks.
+ *
+ * Return value: Number of readable blocks
+ */
 guint
 uca_ring_buffer_get_num_blocks (UcaRingBuffer *buffer)
 {
@@ -173,16 +628,416 @@ uca_ring_buffer_get_num_blocks (UcaRingBuffer *buffer)
 
     g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), 0);
     priv = buffer->priv;
-    return priv->write_index < priv->n_blocks_total ? priv->write_index : priv->n_blocks_total;
+    return get_distance (priv,
+                         (guint) g_atomic_int_get (&priv->write_index),
+                         (guint) g_atomic_int_get (&priv->read_index));
+}
+
+/**
+ * uca_ring_buffer_set_overrun_policy:
+ * @buffer: A #UcaRingBuffer object
+ * @policy: A #UcaRingBufferOverrunPolicy
+ *
+ * Set what happens when the writer catches up with the reader.
+ *
+ * Since: 2.3
+ */
+void
+uca_ring_buffer_set_overrun_policy (UcaRingBuffer *buffer,
+                                    UcaRingBufferOverrunPolicy policy)
+{
+    g_return_if_fail (UCA_IS_RING_BUFFER (buffer));
+    g_object_set (buffer, "overrun-policy", policy, NULL);
+}
+
+/**
+ * uca_ring_buffer_get_overrun_policy:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Return value: The current #UcaRingBufferOverrunPolicy
+ * Since: 2.3
+ */
+UcaRingBufferOverrunPolicy
+uca_ring_buffer_get_overrun_policy (UcaRingBuffer *buffer)
+{
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST);
+    return buffer->priv->policy;
+}
+
+/**
+ * uca_ring_buffer_get_fill_level:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Get the number of blocks written but not yet read. The value is only a
+ * hint if reader and writer run concurrently.
+ *
+ * Return value: Number of filled blocks
+ * Since: 2.3
+ */
+guint
+uca_ring_buffer_get_fill_level (UcaRingBuffer *buffer)
+{
+    UcaRingBufferPrivate *priv;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), 0);
+    priv = buffer->priv;
+    return get_distance (priv, (guint) g_atomic_int_get (&priv->write_index),
+                         (guint) g_atomic_int_get (&priv->read_index));
 }
 
+/**
+ * uca_ring_buffer_get_num_overruns:
+ * @buffer: A #UcaRingBuffer object
+ *
+ * Get the number of times the writer found the ring full or the next block
+ * borrowed since creation or the last uca_ring_buffer_reset(). Each dropped
+ * block and each blocked write is counted once.
+ *
+ * Return value: Number of overruns
+ * Since: 2.3
+ */
+guint
+uca_ring_buffer_get_num_overruns (UcaRingBuffer *buffer)
+{
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), 0);
+    return (guint) g_atomic_int_get (&buffer->priv->n_overruns);
+}
+
+/**
+ * uca_ring_buffer_get_info:
+ * @buffer: A #UcaRingBuffer object
+ * @data: Pointer to a block of @buffer
+ *
+ * Get the frame meta data that belongs to the block pointed to by @data. The
+ * writer fills it before calling uca_ring_buffer_write_advance().
+ *
+ * Return value: (transfer none): Meta data of the block
+ * Since: 2.3
+ */
+UcaFrameInfo *
+uca_ring_buffer_get_info (UcaRingBuffer *buffer,
+                          gpointer data)
+{
+    UcaRingBufferPrivate *priv;
+    guint index;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (buffer), NULL);
+    priv = buffer->priv;
+
+    index = get_block_index (priv, data);
+    g_return_val_if_fail (index <= priv->n_blocks_total, NULL);
+
+    return &priv->info[index];
+}
+
+/**
+ * uca_frame_info_copy:
+ * @info: A #UcaFrameInfo
+ *
+ * Return value: (transfer full): A newly allocated copy of @info
+ * Since: 2.3
+ */
+UcaFrameInfo *
+uca_frame_info_copy (const UcaFrameInfo *info)
+{
+    g_return_val_if_fail (info != NULL, NULL);
+    return g_slice_dup (UcaFrameInfo, info);
+}
+
+/**
+ * uca_frame_info_free:
+ * @info: A #UcaFrameInfo allocated with uca_frame_info_copy()
+ *
+ * Since: 2.3
+ */
+void
+uca_frame_info_free (UcaFrameInfo *info)
+{
+    g_slice_free (UcaFrameInfo, info);
+}
+
+#ifdef HAVE_SYS_MMAN_H
 static void
-realloc_mem (UcaRingBufferPrivate *priv)
+bind_to_node (UcaRingBufferPrivate *priv)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    /* MPOL_BIND from <numaif.h>, we do not want to depend on libnuma */
+    const gint mpol_bind = 2;
+    gulong mask[4] = { 0, };
+    const gulong bits = sizeof (gulong) * 8;
+
+    if (priv->numa_node >= (gint) (G_N_ELEMENTS (mask) * bits)) {
+        g_warning ("NUMA node %i out of range", priv->numa_node);
+        return;
+    }
+
+    mask[priv->numa_node / bits] = 1UL << (priv->numa_node % bits);
+
+    if (syscall (SYS_mbind, priv->data, priv->mapped_size, mpol_bind, mask, G_N_ELEMENTS (mask) * bits, 0) != 0)
+        g_warning ("Could not bind ring buffer to NUMA node %i: %s", priv->numa_node, g_strerror (errno));
+#else
+    g_warning ("Binding to NUMA nodes is not supported on this platform");
+#endif
+}
+
+static gboolean
+map_mem (UcaRingBufferPrivate *priv, gsize size)
+{
+    const gsize huge_page_size = 2 * 1024 * 1024;
+    gpointer data = MAP_FAILED;
+    gint flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_POPULATE
+    /* Binding to a node must happen before the pages are faulted in */
+    if ((priv->alloc_flags & UCA_RING_BUFFER_ALLOC_POPULATE) && priv->numa_node < 0)
+        flags |= MAP_POPULATE;
+#endif
+
+#ifdef MAP_HUGETLB
+    if (priv->alloc_flags & UCA_RING_BUFFER_ALLOC_HUGEPAGES) {
+        priv->mapped_size = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+        data = mmap (NULL, priv->mapped_size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+
+        if (data == MAP_FAILED)
+            g_debug ("Huge page pool exhausted, falling back to regular pages");
+    }
+#endif
+
+    if (data == MAP_FAILED) {
+        gsize page_size = (gsize) sysconf (_SC_PAGESIZE);
+
+        priv->mapped_size = (size + page_size - 1) & ~(page_size - 1);
+        data = mmap (NULL, priv->mapped_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    }
+
+    if (data == MAP_FAILED) {
+        priv->mapped_size = 0;
+        return FALSE;
+    }
+
+    priv->data = data;
+
+#ifdef MADV_HUGEPAGE
+    if (priv->alloc_flags & UCA_RING_BUFFER_ALLOC_TRANSPARENT_HUGEPAGES)
+        madvise (priv->data, priv->mapped_size, MADV_HUGEPAGE);
+#endif
+
+    if (priv->numa_node >= 0)
+        bind_to_node (priv);
+
+    if ((priv->alloc_flags & UCA_RING_BUFFER_ALLOC_POPULATE) && !(flags & MAP_POPULATE)) {
+        gsize page_size = (gsize) sysconf (_SC_PAGESIZE);
+
+        /* Anonymous pages are zero already, writing one byte faults them in */
+        for (gsize offset = 0; offset < priv->mapped_size; offset += page_size)
+            priv->data[offset] = 0;
+    }
+
+    if ((priv->alloc_flags & UCA_RING_BUFFER_ALLOC_LOCK) && mlock (priv->data, priv->mapped_size) != 0)
+        g_warning ("Could not lock ring buffer memory: %s", g_strerror (errno));
+
+    return TRUE;
+}
+
+static void
+set_file_error (UcaRingBufferPrivate *priv, const gchar *what)
 {
-    if (priv->data != NULL)
+    gint saved_errno = errno;
+
+    g_clear_error (&priv->alloc_error);
+    g_set_error (&priv->alloc_error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+                 "Could not %s `%s': %s", what, priv->backing_file, g_strerror (saved_errno));
+}
+
+/*
+ * Allocation flags do not apply here: huge pages cannot back regular files,
+ * locking or pre-faulting would defeat the purpose of spilling to disk.
+ */
+static gboolean
+map_file (UcaRingBufferPrivate *priv, gsize size)
+{
+    gpointer data;
+
+    priv->fd = open (priv->backing_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (priv->fd < 0) {
+        set_file_error (priv, "open");
+        return FALSE;
+    }
+
+    if (ftruncate (priv->fd, (off_t) size) != 0) {
+        set_file_error (priv, "resize");
+        goto map_file_close;
+    }
+
+    data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, priv->fd, 0);
+
+    if (data == MAP_FAILED) {
+        set_file_error (priv, "map");
+        goto map_file_close;
+    }
+
+    priv->data = data;
+    priv->mapped_size = size;
+
+#ifdef MADV_SEQUENTIAL
+    madvise (priv->data, priv->mapped_size, MADV_SEQUENTIAL);
+#endif
+
+    return TRUE;
+
+map_file_close:
+    close (priv->fd);
+    priv->fd = -1;
+    return FALSE;
+}
+
+static void
+flush_block (UcaRingBufferPrivate *priv, guint slot, gboolean wait)
+{
+    off_t offset = (off_t) slot * priv->block_size;
+
+#ifdef SYNC_FILE_RANGE_WRITE
+    guint flags = SYNC_FILE_RANGE_WRITE;
+
+    if (wait)
+        flags |= SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WAIT_AFTER;
+
+    sync_file_range (priv->fd, offset, (off_t) priv->block_size, flags);
+#else
+    gsize start = (gsize) offset & ~(priv->page_size - 1);
+
+    msync (priv->data + start, (gsize) offset + priv->block_size - start, wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+static void
+evict_block (UcaRingBufferPrivate *priv, guint slot)
+{
+    gsize start;
+    gsize end;
+
+    flush_block (priv, slot, TRUE);
+
+    /* Only drop pages that do not overlap neighbouring blocks */
+    start = (slot * priv->block_size + priv->page_size - 1) & ~(priv->page_size - 1);
+    end = ((slot + 1) * priv->block_size) & ~(priv->page_size - 1);
+
+    if (end <= start)
+        return;
+
+    /* The data stays in the file and is faulted in again when it is read */
+    madvise (priv->data + start, end - start, MADV_DONTNEED);
+    posix_fadvise (priv->fd, (off_t) start, (off_t) (end - start), POSIX_FADV_DONTNEED);
+}
+
+/*
+ * Start writing back the block in @slot and evict the block that was written
+ * WRITE_BEHIND_BYTES earlier, which has hopefully reached the disk already.
+ */
+static void
+write_behind (UcaRingBufferPrivate *priv, guint slot)
+{
+    guint window;
+    guint old;
+
+    flush_block (priv, slot, FALSE);
+
+    if (priv->n_blocks_total < 2)
+        return;
+
+    window = (guint) MIN (WRITE_BEHIND_BYTES / MAX (priv->block_size, 1), G_MAXUINT);
+    window = CLAMP (window, 1, priv->n_blocks_total - 1);
+
+    old = (slot + priv->n_blocks_total - window) % priv->n_blocks_total;
+
+    if (g_atomic_int_get (&priv->pinned[old]) == 0)
+        evict_block (priv, old);
+}
+#else
+static void
+write_behind (UcaRingBufferPrivate *priv, guint slot)
+{
+}
+#endif
+
+static void
+free_mem (UcaRingBufferPrivate *priv)
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (priv->mapped_size > 0) {
+        /* munmap() also drops an mlock() */
+        munmap (priv->data, priv->mapped_size);
+        priv->mapped_size = 0;
+    }
+    else
         g_free (priv->data);
 
-    priv->data = g_malloc0_n (priv->n_blocks_total, priv->block_size);
+    if (priv->fd >= 0) {
+        close (priv->fd);
+        priv->fd = -1;
+    }
+#else
+    g_free (priv->data);
+#endif
+
+    g_free (priv->pinned);
+    g_free (priv->info);
+    priv->data = NULL;
+    priv->pinned = NULL;
+    priv->info = NULL;
+}
+
+static void
+realloc_mem (UcaRingBufferPrivate *priv)
+{
+    gsize size;
+
+    free_mem (priv);
+
+    /* One additional scratch block receives frames that are dropped */
+    size = (priv->n_blocks_total + 1) * priv->block_size;
+
+#ifdef HAVE_SYS_MMAN_H
+    priv->page_size = (gsize) sysconf (_SC_PAGESIZE);
+
+    if (priv->backing_file != NULL && size > 0) {
+        /*
+         * No fallback to memory, the file is usually larger than that. The
+         * buffer stays without blocks and g_initable_init() fails.
+         */
+        if (!map_file (priv, size))
+            return;
+
+        g_clear_error (&priv->alloc_error);
+    }
+    else if (!map_mem (priv, size))
+        priv->data = g_malloc (size);
+#else
+    if (priv->backing_file != NULL) {
+        g_clear_error (&priv->alloc_error);
+        g_set_error_literal (&priv->alloc_error, G_FILE_ERROR, G_FILE_ERROR_NOSYS,
+                             "File-backed ring buffers are not supported on this platform");
+        return;
+    }
+
+    priv->data = g_malloc (size);
+#endif
+
+    priv->pinned = g_new0 (gint, priv->n_blocks_total);
+    priv->info = g_new0 (UcaFrameInfo, priv->n_blocks_total + 1);
+
+    priv->is_pow2 = priv->n_blocks_total > 0 && (priv->n_blocks_total & (priv->n_blocks_total - 1)) == 0;
+    priv->mask = priv->n_blocks_total - 1;
+
+    /* Wrap indices at the largest multiple that fits into a gint */
+    priv->wrap = MAX (priv->n_blocks_total, 1);
+
+    while (priv->wrap <= G_MAXINT / 2)
+        priv->wrap *= 2;
+
+    priv->write_index = 0;
+    priv->read_index = 0;
 }
 
 static void
@@ -205,6 +1060,22 @@ uca_ring_buffer_get_property (GObject *object,
             g_value_set_uint (value, priv->n_blocks_total);
             break;
 
+        case PROP_OVERRUN_POLICY:
+            g_value_set_enum (value, priv->policy);
+            break;
+
+        case PROP_ALLOC_FLAGS:
+            g_value_set_flags (value, priv->alloc_flags);
+            break;
+
+        case PROP_NUMA_NODE:
+            g_value_set_int (value, priv->numa_node);
+            break;
+
+        case PROP_BACKING_FILE:
+            g_value_set_string (value, priv->backing_file);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
             break;
@@ -223,14 +1094,36 @@ uca_ring_buffer_set_property (GObject *object,
     priv = UCA_RING_BUFFER_GET_PRIVATE (object);
 
     switch (property_id) {
+        /* During construction memory is allocated once in constructed() */
         case PROP_BLOCK_SIZE:
             priv->block_size = (gsize) g_value_get_uint64 (value);
-            realloc_mem (priv);
+
+            if (priv->info != NULL)
+                realloc_mem (priv);
             break;
 
         case PROP_NUM_BLOCKS:
             priv->n_blocks_total = g_value_get_uint (value);
-            realloc_mem (priv);
+
+            if (priv->info != NULL)
+                realloc_mem (priv);
+            break;
+
+        case PROP_OVERRUN_POLICY:
+            priv->policy = g_value_get_enum (value);
+            break;
+
+        case PROP_ALLOC_FLAGS:
+            priv->alloc_flags = g_value_get_flags (value);
+            break;
+
+        case PROP_NUMA_NODE:
+            priv->numa_node = g_value_get_int (value);
+            break;
+
+        case PROP_BACKING_FILE:
+            g_free (priv->backing_file);
+            priv->backing_file = g_value_dup_string (value);
             break;
 
         default:
@@ -239,6 +1132,47 @@ uca_ring_buffer_set_property (GObject *object,
     }
 }
 
+static void
+uca_ring_buffer_constructed (GObject *object)
+{
+    UcaRingBufferPrivate *priv;
+
+    priv = UCA_RING_BUFFER_GET_PRIVATE (object);
+
+    /* A backing file can fail to map, which is reported by initable_init() */
+    if (priv->backing_file == NULL)
+        realloc_mem (priv);
+
+    G_OBJECT_CLASS (uca_ring_buffer_parent_class)->constructed (object);
+}
+
+static gboolean
+uca_ring_buffer_initable_init (GInitable *initable,
+                               GCancellable *cancellable,
+                               GError **error)
+{
+    UcaRingBufferPrivate *priv;
+
+    g_return_val_if_fail (UCA_IS_RING_BUFFER (initable), FALSE);
+    priv = UCA_RING_BUFFER_GET_PRIVATE (initable);
+
+    if (priv->info == NULL && priv->alloc_error == NULL)
+        realloc_mem (priv);
+
+    if (priv->alloc_error != NULL) {
+        g_propagate_error (error, g_error_copy (priv->alloc_error));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+uca_ring_buffer_initable_iface_init (GInitableIface *iface)
+{
+    iface->init = uca_ring_buffer_initable_init;
+}
+
 static void
 uca_ring_buffer_dispose (GObject *object)
 {
@@ -251,8 +1185,9 @@ uca_ring_buffer_finalize (GObject *object)
     UcaRingBufferPrivate *priv;
 
     priv = UCA_RING_BUFFER_GET_PRIVATE (object);
-    g_free (priv->data);
-    priv->data = NULL;
+    free_mem (priv);
+    g_free (priv->backing_file);
+    g_clear_error (&priv->alloc_error);
     G_OBJECT_CLASS (uca_ring_buffer_parent_class)->finalize (object);
 }
 
@@ -265,6 +1200,7 @@ uca_ring_buffer_class_init (UcaRingBufferClass *klass)
 
     oclass->get_property = uca_ring_buffer_get_property;
     oclass->set_property = uca_ring_buffer_set_property;
+    oclass->constructed = uca_ring_buffer_constructed;
     oclass->dispose = uca_ring_buffer_dispose;
     oclass->finalize = uca_ring_buffer_finalize;
 
@@ -282,6 +1218,36 @@ uca_ring_buffer_class_init (UcaRingBufferClass *klass)
                            0, G_MAXUINT, 0,
                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
 
+    properties[PROP_OVERRUN_POLICY] =
+        g_param_spec_enum ("overrun-policy",
+                           "Overrun policy",
+                           "What happens when the writer catches up with the reader",
+                           UCA_TYPE_RING_BUFFER_OVERRUN_POLICY,
+                           UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST,
+                           G_PARAM_READWRITE);
+
+    properties[PROP_ALLOC_FLAGS] =
+        g_param_spec_flags ("alloc-flags",
+                            "Allocation flags",
+                            "How the block memory is allocated",
+                            UCA_TYPE_RING_BUFFER_ALLOC_FLAGS,
+                            UCA_RING_BUFFER_ALLOC_DEFAULT,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+    properties[PROP_NUMA_NODE] =
+        g_param_spec_int ("numa-node",
+                          "NUMA node",
+                          "NUMA node the block memory is bound to, -1 for no binding",
+                          -1, G_MAXINT, -1,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+    properties[PROP_BACKING_FILE] =
+        g_param_spec_string ("backing-file",
+                             "Backing file",
+                             "File that holds the blocks instead of memory or NULL",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
     for (guint i = PROP_0 + 1; i < N_PROPERTIES; i++)
         g_object_class_install_property (oclass, i, properties[i]);
 
@@ -297,4 +1263,18 @@ uca_ring_buffer_init (UcaRingBuffer *buffer)
     priv->n_blocks_total = 0;
     priv->block_size = 0;
     priv->data = NULL;
+    priv->pinned = NULL;
+    priv->info = NULL;
+    priv->write_index = 0;
+    priv->read_index = 0;
+    priv->n_overruns = 0;
+    priv->write_to_scratch = FALSE;
+    priv->blocked = FALSE;
+    priv->policy = UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST;
+    priv->alloc_flags = UCA_RING_BUFFER_ALLOC_DEFAULT;
+    priv->numa_node = -1;
+    priv->mapped_size = 0;
+    priv->backing_file = NULL;
+    priv->fd = -1;
+    priv->alloc_error = NULL;
 }
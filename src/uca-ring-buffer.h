@@ -10,12 +10,37 @@
 #define UCA_IS_RING_BUFFER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), UCA_TYPE_RING_BUFFER))
 #define UCA_RING_BUFFER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), UCA_TYPE_RING_BUFFER, UcaRingBufferClass))
 
+#define UCA_TYPE_FRAME_INFO              (uca_frame_info_get_type())
+
 G_BEGIN_DECLS
 
+typedef enum {
+    UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK,
+    UCA_RING_BUFFER_OVERRUN_POLICY_DROP_NEWEST,
+    UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST
+} UcaRingBufferOverrunPolicy;
+
+typedef enum {
+    UCA_RING_BUFFER_ALLOC_DEFAULT                   = 0,
+    UCA_RING_BUFFER_ALLOC_TRANSPARENT_HUGEPAGES     = 1 << 0,
+    UCA_RING_BUFFER_ALLOC_HUGEPAGES                 = 1 << 1,
+    UCA_RING_BUFFER_ALLOC_LOCK                      = 1 << 2,
+    UCA_RING_BUFFER_ALLOC_POPULATE                  = 1 << 3
+} UcaRingBufferAllocFlags;
+
+typedef struct _UcaFrameInfo            UcaFrameInfo;
 typedef struct _UcaRingBuffer           UcaRingBuffer;
 typedef struct _UcaRingBufferClass      UcaRingBufferClass;
 typedef struct _UcaRingBufferPrivate    UcaRingBufferPrivate;
 
+struct _UcaFrameInfo {
+    guint64 sequence;
+    guint64 hw_sequence;
+    gint64  grab_start;
+    gint64  grab_end;
+    guint   n_dropped;
+};
+
 struct _UcaRingBuffer {
     /*< private >*/
     GObject parent;
@@ -30,6 +55,14 @@ struct _UcaRingBufferClass {
 
 UcaRingBuffer * uca_ring_buffer_new                 (gsize          block_size,
                                                      guint          n_blocks);
+UcaRingBuffer * uca_ring_buffer_new_mapped          (const gchar   *filename,
+                                                     gsize          block_size,
+                                                     guint          n_blocks,
+                                                     GError       **error);
+UcaRingBuffer * uca_ring_buffer_new_full            (gsize          block_size,
+                                                     guint          n_blocks,
+                                                     UcaRingBufferAllocFlags flags,
+                                                     gint           numa_node);
 void            uca_ring_buffer_reset               (UcaRingBuffer *buffer);
 gsize           uca_ring_buffer_get_block_size      (UcaRingBuffer *buffer);
 guint           uca_ring_buffer_get_num_blocks      (UcaRingBuffer *buffer);
@@ -37,12 +70,31 @@ gboolean        uca_ring_buffer_available           (UcaRingBuffer *buffer);
 void            uca_ring_buffer_proceed             (UcaRingBuffer *buffer);
 gpointer        uca_ring_buffer_get_read_pointer    (UcaRingBuffer *buffer);
 gpointer        uca_ring_buffer_get_write_pointer   (UcaRingBuffer *buffer);
-void            uca_ring_buffer_write_advance       (UcaRingBuffer *buffer);
+gboolean        uca_ring_buffer_write_advance       (UcaRingBuffer *buffer);
 gpointer        uca_ring_buffer_get_pointer         (UcaRingBuffer *buffer,
                                                      guint          index);
 gpointer        uca_ring_buffer_peek_pointer        (UcaRingBuffer *buffer);
+gpointer        uca_ring_buffer_borrow_read_pointer (UcaRingBuffer *buffer);
+void            uca_ring_buffer_pin_pointer         (UcaRingBuffer *buffer,
+                                                     gpointer       data);
+void            uca_ring_buffer_release_pointer     (UcaRingBuffer *buffer,
+                                                     gpointer       data);
+gboolean        uca_ring_buffer_is_pinned           (UcaRingBuffer *buffer,
+                                                     gpointer       data);
+void            uca_ring_buffer_set_overrun_policy  (UcaRingBuffer *buffer,
+                                                     UcaRingBufferOverrunPolicy policy);
+UcaRingBufferOverrunPolicy
+                uca_ring_buffer_get_overrun_policy  (UcaRingBuffer *buffer);
+guint           uca_ring_buffer_get_fill_level      (UcaRingBuffer *buffer);
+guint           uca_ring_buffer_get_num_overruns    (UcaRingBuffer *buffer);
+UcaFrameInfo *  uca_ring_buffer_get_info            (UcaRingBuffer *buffer,
+                                                     gpointer       data);
+
+UcaFrameInfo *  uca_frame_info_copy                 (const UcaFrameInfo *info);
+void            uca_frame_info_free                 (UcaFrameInfo  *info);
 
 GType uca_ring_buffer_get_type (void);
+GType uca_frame_info_get_type (void);
 
 G_END_DECLS
 
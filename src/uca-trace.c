@@ -0,0 +1,389 @@
+/* Copyright (C) 2026 The libuca contributors
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+   details.
+
+   You should have received a copy of the GNU Lesser General Public License along
+   with this library; if not, write to the Free Software Foundation, Inc., 51
+   Franklin St, Fifth Floor, Boston, MA 02110, USA */
+
+/**
+ * SECTION:uca-trace
+ * @Short_description: Acquisition trace recorder
+ * @Title: Tracing
+ *
+ * The trace recorder keeps a ring of the most recent events per thread:
+ * #UcaCamera entry points, plugin virtual method calls, lock waits and ring
+ * buffer fill levels. Tracing is disabled by default and costs a single
+ * atomic read per event in that case. Once enabled with uca_trace_enable(),
+ * events are written to a thread-local ring without any locking.
+ *
+ * uca_trace_dump() writes the recorded events in the Chrome trace event
+ * format which can be loaded with chrome://tracing or Perfetto. If the
+ * `UCA_TRACE` environment variable is set to a file name, tracing is enabled
+ * when libuca is loaded and the trace is dumped to that file at exit.
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#include "uca-trace.h"
+
+/* Number of events kept per thread, must be a power of two */
+#define TRACE_BUFFER_SIZE   16384
+
+typedef struct {
+    gint64 timestamp;
+    const gchar *name;
+    guint64 value;
+    gchar phase;
+} TraceEvent;
+
+typedef struct {
+    TraceEvent *events;
+    gint n_written;
+    gint generation;
+    guint tid;
+    gchar name[17];
+    gboolean retired;
+} TraceBuffer;
+
+static void retire_buffer (gpointer data);
+
+static gint trace_enabled = 0;
+static gint trace_generation = 0;
+static GMutex trace_lock;
+static GList *trace_buffers = NULL;
+static guint trace_next_tid = 1;
+static GPrivate trace_private = G_PRIVATE_INIT (retire_buffer);
+
+static void
+retire_buffer (gpointer data)
+{
+    g_mutex_lock (&trace_lock);
+    ((TraceBuffer *) data)->retired = TRUE;
+    g_mutex_unlock (&trace_lock);
+}
+
+static void
+get_thread_name (TraceBuffer *buffer)
+{
+    memset (buffer->name, 0, sizeof (buffer->name));
+
+#ifdef __linux__
+    if (prctl (PR_GET_NAME, buffer->name, 0, 0, 0) == 0 && buffer->name[0] != '\0') {
+        /* The name ends up in a JSON string */
+        for (gchar *c = buffer->name; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\' || !g_ascii_isprint (*c))
+                *c = '_';
+        }
+
+        return;
+    }
+#endif
+
+    g_snprintf (buffer->name, sizeof (buffer->name), "thread %u", buffer->tid);
+}
+
+static TraceBuffer *
+get_buffer (void)
+{
+    TraceBuffer *buffer = NULL;
+    gint generation;
+
+    generation = g_atomic_int_get (&trace_generation);
+    g_mutex_lock (&trace_lock);
+
+    /* Recycle buffers of exited threads that hold no current events */
+    for (GList *it = trace_buffers; it != NULL; it = g_list_next (it)) {
+        TraceBuffer *candidate = (TraceBuffer *) it->data;
+
+        if (candidate->retired && candidate->generation != generation) {
+            buffer = candidate;
+            break;
+        }
+    }
+
+    if (buffer == NULL) {
+        buffer = g_new0 (TraceBuffer, 1);
+        buffer->events = g_new0 (TraceEvent, TRACE_BUFFER_SIZE);
+        trace_buffers = g_list_append (trace_buffers, buffer);
+    }
+
+    buffer->tid = trace_next_tid++;
+    buffer->retired = FALSE;
+    buffer->generation = generation;
+    g_atomic_int_set (&buffer->n_written, 0);
+    get_thread_name (buffer);
+
+    g_mutex_unlock (&trace_lock);
+
+    g_private_set (&trace_private, buffer);
+    return buffer;
+}
+
+static void
+trace_event (gchar phase, const gchar *name, guint64 value)
+{
+    TraceBuffer *buffer;
+    TraceEvent *event;
+    guint index;
+    gint generation;
+
+    if (G_LIKELY (!g_atomic_int_get (&trace_enabled)))
+        return;
+
+    buffer = g_private_get (&trace_private);
+
+    if (G_UNLIKELY (buffer == NULL))
+        buffer = get_buffer ();
+
+    generation = g_atomic_int_get (&trace_generation);
+
+    if (G_UNLIKELY (buffer->generation != generation)) {
+        g_atomic_int_set (&buffer->n_written, 0);
+        buffer->generation = generation;
+    }
+
+    index = (guint) buffer->n_written;
+    event = &buffer->events[index & (TRACE_BUFFER_SIZE - 1)];
+    event->timestamp = g_get_monotonic_time ();
+    event->name = name;
+    event->value = value;
+    event->phase = phase;
+
+    /* Publish the event only after it has been written completely */
+    g_atomic_int_set (&buffer->n_written, (gint) (index + 1));
+}
+
+/**
+ * uca_trace_enable:
+ * @enable: %TRUE to record events
+ *
+ * Enable or disable recording of trace events. Events recorded so far are
+ * kept until uca_trace_clear() is called.
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_enable (gboolean enable)
+{
+    g_atomic_int_set (&trace_enabled, enable ? 1 : 0);
+}
+
+/**
+ * uca_trace_is_enabled:
+ *
+ * Returns: %TRUE if trace events are recorded.
+ * Since: 2.3
+ */
+gboolean
+uca_trace_is_enabled (void)
+{
+    return g_atomic_int_get (&trace_enabled) != 0;
+}
+
+/**
+ * uca_trace_clear:
+ *
+ * Discard all recorded events. Buffers of threads that exited are freed.
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_clear (void)
+{
+    GList *it;
+
+    g_mutex_lock (&trace_lock);
+    g_atomic_int_inc (&trace_generation);
+
+    it = trace_buffers;
+
+    while (it != NULL) {
+        TraceBuffer *buffer = (TraceBuffer *) it->data;
+        GList *next = g_list_next (it);
+
+        if (buffer->retired) {
+            g_free (buffer->events);
+            g_free (buffer);
+            trace_buffers = g_list_delete_link (trace_buffers, it);
+        }
+
+        it = next;
+    }
+
+    g_mutex_unlock (&trace_lock);
+}
+
+/**
+ * uca_trace_begin:
+ * @name: Name of the span, must be a static string
+ *
+ * Record the start of a span on the calling thread. Spans must be closed on
+ * the same thread with uca_trace_end() and can be nested.
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_begin (const gchar *name)
+{
+    trace_event ('B', name, 0);
+}
+
+/**
+ * uca_trace_end:
+ * @name: Name of the span, must be a static string
+ *
+ * Record the end of a span started with uca_trace_begin().
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_end (const gchar *name)
+{
+    trace_event ('E', name, 0);
+}
+
+/**
+ * uca_trace_instant:
+ * @name: Name of the event, must be a static string
+ * @value: Value attached to the event, e.g. a frame sequence number
+ *
+ * Record a single point in time on the calling thread.
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_instant (const gchar *name, guint64 value)
+{
+    trace_event ('i', name, value);
+}
+
+/**
+ * uca_trace_counter:
+ * @name: Name of the counter, must be a static string
+ * @value: Current value of the counter
+ *
+ * Record a new value of a counter such as the ring buffer fill level. Trace
+ * viewers show counters as a graph over time.
+ *
+ * Since: 2.3
+ */
+void
+uca_trace_counter (const gchar *name, guint64 value)
+{
+    trace_event ('C', name, value);
+}
+
+static void
+append_buffer (GString *json, TraceBuffer *buffer, gint pid, gboolean *first)
+{
+    guint n_written;
+    guint start;
+
+    n_written = (guint) g_atomic_int_get (&buffer->n_written);
+    start = n_written > TRACE_BUFFER_SIZE ? n_written - TRACE_BUFFER_SIZE : 0;
+
+    g_string_append_printf (json, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                            *first ? "" : ",", pid, buffer->tid, buffer->name);
+    *first = FALSE;
+
+    for (guint i = start; i != n_written; i++) {
+        TraceEvent *event = &buffer->events[i & (TRACE_BUFFER_SIZE - 1)];
+
+        g_string_append_printf (json, ",\n{\"name\":\"%s\",\"cat\":\"uca\",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":%i,\"tid\":%u",
+                                event->name, event->phase, event->timestamp, pid, buffer->tid);
+
+        switch (event->phase) {
+            case 'i':
+                g_string_append_printf (json, ",\"s\":\"t\",\"args\":{\"value\":%" G_GUINT64_FORMAT "}}", event->value);
+                break;
+            case 'C':
+                g_string_append_printf (json, ",\"args\":{\"value\":%" G_GUINT64_FORMAT "}}", event->value);
+                break;
+            default:
+                g_string_append_c (json, '}');
+        }
+    }
+}
+
+/**
+ * uca_trace_dump:
+ * @filename: Name of the file to write
+ * @error: Location to store a #GFileError or %NULL
+ *
+ * Write all recorded events as a Chrome trace event JSON file. Threads that
+ * are still recording may overwrite their oldest events while the dump runs,
+ * disable tracing first for an exact snapshot.
+ *
+ * Returns: %TRUE if the file was written.
+ * Since: 2.3
+ */
+gboolean
+uca_trace_dump (const gchar *filename, GError **error)
+{
+    GString *json;
+    gboolean first = TRUE;
+    gboolean result;
+    gint generation;
+    gint pid;
+
+    g_return_val_if_fail (filename != NULL, FALSE);
+
+    json = g_string_new ("{\"traceEvents\":[");
+    pid = (gint) getpid ();
+
+    g_mutex_lock (&trace_lock);
+    generation = g_atomic_int_get (&trace_generation);
+
+    for (GList *it = trace_buffers; it != NULL; it = g_list_next (it)) {
+        TraceBuffer *buffer = (TraceBuffer *) it->data;
+
+        if (buffer->generation == generation)
+            append_buffer (json, buffer, pid, &first);
+    }
+
+    g_mutex_unlock (&trace_lock);
+
+    g_string_append (json, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    result = g_file_set_contents (filename, json->str, (gssize) json->len, error);
+    g_string_free (json, TRUE);
+
+    return result;
+}
+
+static void
+dump_to_env_file (void)
+{
+    GError *error = NULL;
+
+    if (!uca_trace_dump (g_getenv ("UCA_TRACE"), &error)) {
+        g_warning ("Could not write trace: %s", error->message);
+        g_error_free (error);
+    }
+}
+
+static void __attribute__((constructor))
+enable_from_env (void)
+{
+    const gchar *filename;
+
+    filename = g_getenv ("UCA_TRACE");
+
+    if (filename != NULL && filename[0] != '\0') {
+        uca_trace_enable (TRUE);
+        atexit (dump_to_env_file);
+    }
+}
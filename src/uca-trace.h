@@ -0,0 +1,22 @@
+#ifndef UCA_TRACE_H
+#define UCA_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void        uca_trace_enable        (gboolean        enable);
+gboolean    uca_trace_is_enabled    (void);
+void        uca_trace_clear         (void);
+gboolean    uca_trace_dump          (const gchar    *filename,
+                                     GError        **error);
+void        uca_trace_begin         (const gchar    *name);
+void        uca_trace_end           (const gchar    *name);
+void        uca_trace_instant       (const gchar    *name,
+                                     guint64         value);
+void        uca_trace_counter       (const gchar    *name,
+                                     guint64         value);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,381 @@
+/* Copyright (C) 2026 The libuca contributors
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+   details.
+
+   You should have received a copy of the GNU Lesser General Public License along
+   with this library; if not, write to the Free Software Foundation, Inc., 51
+   Franklin St, Fifth Floor, Boston, MA 02110, USA */
+
+/**
+ * SECTION:uca-unpack
+ * @Short_description: Unpacking of packed pixel formats
+ * @Title: Unpacking
+ *
+ * Converts frames in a packed #UcaPixelFormat to
+ * #UCA_PIXEL_FORMAT_MONO16. Vectorized kernels are selected at run-time
+ * according to the instruction sets the CPU supports.
+ */
+
+#include <string.h>
+#include "uca-unpack.h"
+
+/*
+ * The vector kernels are compiled with function-level target attributes, so
+ * the library itself does not need to be built with -mavx2 and friends.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#define MAX_VECTOR_BITS 15
+
+typedef void (*UnpackFunc) (const guint8 *src, guint16 *dst, gsize n_pixels, guint bits);
+
+/*
+ * Each group of eight pixels occupies exactly @bits bytes. Pixel j of a group
+ * starts at byte o = (j * bits) / 8 and bit s = (j * bits) % 8 and is
+ * contained in the 24 bits of bytes o to o + 2. A vector kernel gathers byte o
+ * into the high byte of a 16 bit lane with @lo and bytes o + 1 and o + 2 into
+ * another lane with @hi. Multiplying both with 2^(8 - s) and keeping the high
+ * and low half of the products respectively aligns the pixel at bit 0.
+ */
+typedef struct {
+    guint8  lo[16];
+    guint8  hi[16];
+    guint16 mult[8];
+    guint16 mask;
+} Shuffle;
+
+static Shuffle shuffles[MAX_VECTOR_BITS + 1];
+static UcaUnpackKernel best_kernel = UCA_UNPACK_KERNEL_SCALAR;
+
+static void
+unpack_scalar (const guint8 *src, guint16 *dst, gsize n_pixels, guint bits)
+{
+    const guint32 mask = (1U << bits) - 1;
+    guint32 acc = 0;
+    guint n_bits = 0;
+
+    for (gsize i = 0; i < n_pixels; i++) {
+        for (; n_bits < bits; n_bits += 8)
+            acc |= ((guint32) *src++) << n_bits;
+
+        dst[i] = acc & mask;
+        acc >>= bits;
+        n_bits -= bits;
+    }
+}
+
+/*
+ * Number of whole bytes left in the input for @n_pixels pixels. Vector loads
+ * may read past the bytes they consume but never past this limit.
+ */
+static inline gsize
+input_bytes (gsize n_pixels, guint bits)
+{
+    return (n_pixels * bits) / 8;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+__attribute__((target("ssse3")))
+static void
+unpack_ssse3 (const guint8 *src, guint16 *dst, gsize n_pixels, guint bits)
+{
+    const Shuffle *shuffle = &shuffles[bits];
+    const __m128i lo = _mm_loadu_si128 ((const __m128i *) shuffle->lo);
+    const __m128i hi = _mm_loadu_si128 ((const __m128i *) shuffle->hi);
+    const __m128i mult = _mm_loadu_si128 ((const __m128i *) shuffle->mult);
+    const __m128i mask = _mm_set1_epi16 ((gint16) shuffle->mask);
+
+    while (n_pixels >= 8 && input_bytes (n_pixels, bits) >= 16) {
+        __m128i x = _mm_loadu_si128 ((const __m128i *) src);
+        __m128i a = _mm_mulhi_epu16 (_mm_shuffle_epi8 (x, lo), mult);
+        __m128i b = _mm_mullo_epi16 (_mm_shuffle_epi8 (x, hi), mult);
+
+        _mm_storeu_si128 ((__m128i *) dst, _mm_and_si128 (_mm_or_si128 (a, b), mask));
+        src += bits;
+        dst += 8;
+        n_pixels -= 8;
+    }
+
+    unpack_scalar (src, dst, n_pixels, bits);
+}
+
+__attribute__((target("avx2")))
+static void
+unpack_avx2 (const guint8 *src, guint16 *dst, gsize n_pixels, guint bits)
+{
+    const Shuffle *shuffle = &shuffles[bits];
+    const __m256i lo = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle->lo));
+    const __m256i hi = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle->hi));
+    const __m256i mult = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle->mult));
+    const __m256i mask = _mm256_set1_epi16 ((gint16) shuffle->mask);
+
+    while (n_pixels >= 16 && input_bytes (n_pixels, bits) >= bits + 16) {
+        __m256i x = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 ((const __m128i *) src)),
+                                             _mm_loadu_si128 ((const __m128i *) (src + bits)), 1);
+        __m256i a = _mm256_mulhi_epu16 (_mm256_shuffle_epi8 (x, lo), mult);
+        __m256i b = _mm256_mullo_epi16 (_mm256_shuffle_epi8 (x, hi), mult);
+
+        _mm256_storeu_si256 ((__m256i *) dst, _mm256_and_si256 (_mm256_or_si256 (a, b), mask));
+        src += 2 * bits;
+        dst += 16;
+        n_pixels -= 16;
+    }
+
+    unpack_ssse3 (src, dst, n_pixels, bits);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void
+unpack_avx512 (const guint8 *src, guint16 *dst, gsize n_pixels, guint bits)
+{
+    const Shuffle *shuffle = &shuffles[bits];
+    const __m512i lo = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) shuffle->lo));
+    const __m512i hi = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) shuffle->hi));
+    const __m512i mult = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) shuffle->mult));
+    const __m512i mask = _mm512_set1_epi16 ((gint16) shuffle->mask);
+
+    while (n_pixels >= 32 && input_bytes (n_pixels, bits) >= 3 * bits + 16) {
+        __m512i x = _mm512_castsi128_si512 (_mm_loadu_si128 ((const __m128i *) src));
+        __m512i a, b;
+
+        x = _mm512_inserti32x4 (x, _mm_loadu_si128 ((const __m128i *) (src + bits)), 1);
+        x = _mm512_inserti32x4 (x, _mm_loadu_si128 ((const __m128i *) (src + 2 * bits)), 2);
+        x = _mm512_inserti32x4 (x, _mm_loadu_si128 ((const __m128i *) (src + 3 * bits)), 3);
+        a = _mm512_mulhi_epu16 (_mm512_shuffle_epi8 (x, lo), mult);
+        b = _mm512_mullo_epi16 (_mm512_shuffle_epi8 (x, hi), mult);
+
+        _mm512_storeu_si512 (dst, _mm512_and_si512 (_mm512_or_si512 (a, b), mask));
+        src += 4 * bits;
+        dst += 32;
+        n_pixels -= 32;
+    }
+
+    unpack_avx2 (src, dst, n_pixels, bits);
+}
+
+#endif
+
+static UnpackFunc
+get_func (UcaUnpackKernel kernel)
+{
+    switch (kernel) {
+#ifdef HAVE_X86_KERNELS
+        case UCA_UNPACK_KERNEL_SSSE3:
+            return unpack_ssse3;
+        case UCA_UNPACK_KERNEL_AVX2:
+            return unpack_avx2;
+        case UCA_UNPACK_KERNEL_AVX512:
+            return unpack_avx512;
+#endif
+        default:
+            return unpack_scalar;
+    }
+}
+
+static gpointer
+init_kernels (gpointer data)
+{
+    for (guint bits = 1; bits <= MAX_VECTOR_BITS; bits++) {
+        Shuffle *shuffle = &shuffles[bits];
+
+        shuffle->mask = (1 << bits) - 1;
+
+        for (guint j = 0; j < 8; j++) {
+            guint o = (j * bits) / 8;
+            guint s = (j * bits) % 8;
+
+            shuffle->lo[2 * j] = 0x80;
+            shuffle->lo[2 * j + 1] = o;
+            shuffle->hi[2 * j] = o + 1;
+            shuffle->hi[2 * j + 1] = o + 2;
+            shuffle->mult[j] = 1 << (8 - s);
+        }
+    }
+
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init ();
+
+    if (__builtin_cpu_supports ("avx512bw"))
+        best_kernel = UCA_UNPACK_KERNEL_AVX512;
+    else if (__builtin_cpu_supports ("avx2"))
+        best_kernel = UCA_UNPACK_KERNEL_AVX2;
+    else if (__builtin_cpu_supports ("ssse3"))
+        best_kernel = UCA_UNPACK_KERNEL_SSSE3;
+#endif
+
+    return NULL;
+}
+
+static void
+ensure_kernels (void)
+{
+    static GOnce once = G_ONCE_INIT;
+    g_once (&once, init_kernels, NULL);
+}
+
+/**
+ * UcaUnpackKernel:
+ * @UCA_UNPACK_KERNEL_SCALAR: Portable C implementation
+ * @UCA_UNPACK_KERNEL_SSSE3: 128 bit SSSE3 implementation
+ * @UCA_UNPACK_KERNEL_AVX2: 256 bit AVX2 implementation
+ * @UCA_UNPACK_KERNEL_AVX512: 512 bit AVX-512BW implementation
+ *
+ * Implementations of the unpacking routines. Wider kernels fall back to
+ * narrower ones for the tail of a row.
+ *
+ * Since: 2.3
+ */
+
+/**
+ * uca_unpack_get_kernel:
+ *
+ * Return value: The fastest #UcaUnpackKernel supported by this CPU, which is
+ *      used by uca_unpack() and uca_unpack_frame().
+ * Since: 2.3
+ */
+UcaUnpackKernel
+uca_unpack_get_kernel (void)
+{
+    ensure_kernels ();
+    return best_kernel;
+}
+
+/**
+ * uca_unpack_kernel_is_supported:
+ * @kernel: A #UcaUnpackKernel
+ *
+ * Return value: %TRUE if @kernel can run on this CPU.
+ * Since: 2.3
+ */
+gboolean
+uca_unpack_kernel_is_supported (UcaUnpackKernel kernel)
+{
+    return kernel <= uca_unpack_get_kernel ();
+}
+
+/**
+ * uca_unpack:
+ * @src: Packed pixels
+ * @dst: (array length=n_pixels): Location to store @n_pixels unpacked pixels
+ * @n_pixels: Number of pixels
+ * @bits: Number of bits per packed pixel, between 1 and 16
+ *
+ * Unpack a little-endian bit stream of @n_pixels pixels as described for
+ * #UcaPixelFormat to one 16 bit word per pixel. @src must start at a byte
+ * boundary and hold at least (@n_pixels * @bits + 7) / 8 bytes.
+ *
+ * Since: 2.3
+ */
+void
+uca_unpack (gconstpointer src, guint16 *dst, gsize n_pixels, guint bits)
+{
+    uca_unpack_with_kernel (uca_unpack_get_kernel (), src, dst, n_pixels, bits);
+}
+
+/**
+ * uca_unpack_with_kernel:
+ * @kernel: A #UcaUnpackKernel
+ * @src: Packed pixels
+ * @dst: (array length=n_pixels): Location to store @n_pixels unpacked pixels
+ * @n_pixels: Number of pixels
+ * @bits: Number of bits per packed pixel, between 1 and 16
+ *
+ * Same as uca_unpack() but uses @kernel instead of the fastest one. This is
+ * mainly useful to test and benchmark the kernels against each other.
+ *
+ * Return value: %FALSE if @kernel is not supported on this CPU.
+ * Since: 2.3
+ */
+gboolean
+uca_unpack_with_kernel (UcaUnpackKernel kernel,
+                        gconstpointer src,
+                        guint16 *dst,
+                        gsize n_pixels,
+                        guint bits)
+{
+    g_return_val_if_fail (bits >= 1 && bits <= 16, FALSE);
+    g_return_val_if_fail ((src != NULL && dst != NULL) || n_pixels == 0, FALSE);
+
+    if (!uca_unpack_kernel_is_supported (kernel))
+        return FALSE;
+
+    if (bits == 16)
+        memcpy (dst, src, n_pixels * 2);
+    else
+        get_func (kernel) (src, dst, n_pixels, bits);
+
+    return TRUE;
+}
+
+/**
+ * uca_unpack_get_frame_format:
+ * @format: A #UcaFrameFormat
+ * @unpacked: (out caller-allocates): Location to store the format of @format
+ *      after unpacking
+ *
+ * Packed formats unpack to #UCA_PIXEL_FORMAT_MONO16 without row padding,
+ * other formats are copied unchanged.
+ *
+ * Since: 2.3
+ */
+void
+uca_unpack_get_frame_format (const UcaFrameFormat *format, UcaFrameFormat *unpacked)
+{
+    g_return_if_fail (format != NULL && unpacked != NULL);
+
+    if (uca_pixel_format_is_packed (format->pixel_format))
+        uca_frame_format_init (unpacked, UCA_PIXEL_FORMAT_MONO16,
+                               format->width, format->height, format->bits, 0);
+    else
+        *unpacked = *format;
+}
+
+/**
+ * uca_unpack_frame:
+ * @format: Layout of @src
+ * @src: A frame laid out according to @format
+ * @dst: Location to store the frame as described by
+ *      uca_unpack_get_frame_format()
+ *
+ * Unpack each row of a frame in a packed pixel format.
+ *
+ * Return value: %FALSE if @format is not a packed format.
+ * Since: 2.3
+ */
+gboolean
+uca_unpack_frame (const UcaFrameFormat *format, gconstpointer src, guint16 *dst)
+{
+    const guint8 *row;
+    UnpackFunc func;
+
+    g_return_val_if_fail (format != NULL, FALSE);
+
+    if (!uca_pixel_format_is_packed (format->pixel_format))
+        return FALSE;
+
+    g_return_val_if_fail (format->bits_per_pixel <= MAX_VECTOR_BITS, FALSE);
+
+    func = get_func (uca_unpack_get_kernel ());
+    row = src;
+
+    for (guint y = 0; y < format->height; y++) {
+        func (row, dst, format->width, format->bits_per_pixel);
+        row += format->stride;
+        dst += format->width;
+    }
+
+    return TRUE;
+}
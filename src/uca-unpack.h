@@ -0,0 +1,35 @@
+#ifndef UCA_UNPACK_H
+#define UCA_UNPACK_H
+
+#include <glib-object.h>
+#include "uca-camera.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+    UCA_UNPACK_KERNEL_SCALAR,
+    UCA_UNPACK_KERNEL_SSSE3,
+    UCA_UNPACK_KERNEL_AVX2,
+    UCA_UNPACK_KERNEL_AVX512
+} UcaUnpackKernel;
+
+UcaUnpackKernel uca_unpack_get_kernel           (void);
+gboolean        uca_unpack_kernel_is_supported  (UcaUnpackKernel     kernel);
+void            uca_unpack                      (gconstpointer       src,
+                                                 guint16            *dst,
+                                                 gsize               n_pixels,
+                                                 guint               bits);
+gboolean        uca_unpack_with_kernel          (UcaUnpackKernel     kernel,
+                                                 gconstpointer       src,
+                                                 guint16            *dst,
+                                                 gsize               n_pixels,
+                                                 guint               bits);
+gboolean        uca_unpack_frame                (const UcaFrameFormat *format,
+                                                 gconstpointer       src,
+                                                 guint16            *dst);
+void            uca_unpack_get_frame_format     (const UcaFrameFormat *format,
+                                                 UcaFrameFormat     *unpacked);
+
+G_END_DECLS
+
+#endif
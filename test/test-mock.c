@@ -1,7 +1,12 @@
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <string.h>
 #include "uca-camera.h"
+#include "uca-camera-group.h"
 #include "uca-plugin-manager.h"
+#include "uca-trace.h"
 
 typedef struct {
     UcaPluginManager *manager;
@@ -106,6 +111,7 @@ test_recording_async (Fixture *fixture, gconstpointer data)
 {
     UcaCamera *camera = UCA_CAMERA (fixture->camera);
 
+    gint64 start;
     guint count = 0;
     uca_camera_set_grab_func (camera, grab_func, &count);
 
@@ -124,11 +130,903 @@ test_recording_async (Fixture *fixture, gconstpointer data)
      */
     g_usleep (G_USEC_PER_SEC / 8);
 
+    /* Stopping interrupts the period instead of sleeping until the third frame */
+    start = g_get_monotonic_time ();
     uca_camera_stop_recording (camera, &error);
     g_assert_no_error (error);
+    g_assert_cmpint (g_get_monotonic_time () - start, <, G_USEC_PER_SEC / 20);
     g_assert_cmpint (count, ==, 2);
 }
 
+static void
+slow_grab_func (gpointer data, gpointer user_data)
+{
+    g_usleep (G_USEC_PER_SEC / 20);
+    g_atomic_int_inc ((gint *) user_data);
+}
+
+static void
+test_recording_async_dispatch (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraDispatchStats stats;
+    GError *error = NULL;
+    gint count = 0;
+
+    uca_camera_set_grab_func (camera, slow_grab_func, &count);
+
+    g_object_set (G_OBJECT (camera),
+            "frames-per-second", 100.0,
+            "transfer-asynchronously", TRUE,
+            "dispatch-threads", 4,
+            "dispatch-queue-length", 8,
+            NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_usleep (G_USEC_PER_SEC / 4);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /*
+     * Called inline, the callback would throttle acquisition to five frames.
+     * All queued frames must have been delivered when stop returns.
+     */
+    uca_camera_get_dispatch_stats (camera, &stats);
+    g_assert_cmpuint (stats.n_dispatched, ==, (guint64) count);
+    g_assert_cmpuint (stats.n_dispatched + stats.n_dropped, >, 10);
+    g_assert_cmpuint (stats.queue_depth, ==, 0);
+    g_assert_cmpuint (stats.max_queue_depth, <=, 8);
+    g_assert (stats.max_callback_time >= 0.04);
+}
+
+static void
+test_frame_format (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaFrameFormat format;
+    GError *error = NULL;
+    guint width, height, bitdepth;
+    gpointer buffer;
+
+    g_object_get (G_OBJECT (camera),
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  NULL);
+
+    uca_camera_get_frame_format (camera, &format);
+    g_assert_cmpint (format.pixel_format, ==, UCA_PIXEL_FORMAT_MONO8);
+    g_assert_cmpuint (format.stride, ==, width);
+    g_assert_cmpuint (format.size, ==, width * height);
+
+    g_object_set (G_OBJECT (camera), "pixel-format", UCA_PIXEL_FORMAT_MONO12_PACKED, NULL);
+    g_object_get (G_OBJECT (camera), "sensor-bitdepth", &bitdepth, NULL);
+    g_assert_cmpuint (bitdepth, ==, 12);
+
+    uca_camera_get_frame_format (camera, &format);
+    g_assert (uca_pixel_format_is_packed (format.pixel_format));
+    g_assert_cmpuint (format.bytes_per_pixel, ==, 0);
+    g_assert_cmpuint (format.stride, ==, (width * 12 + 7) / 8);
+    g_assert_cmpuint (uca_camera_get_frame_size (camera), ==, format.stride * height);
+
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.001, NULL);
+    buffer = g_malloc0 (format.size);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+    g_assert (uca_camera_grab (camera, buffer, &error));
+    g_assert_no_error (error);
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+
+    uca_frame_format_init (&format, UCA_PIXEL_FORMAT_MONO10_PACKED, 7, 3, 10, 4);
+    g_assert_cmpuint (format.stride, ==, 9 + 4);
+    g_assert_cmpuint (format.size, ==, 3 * (9 + 4));
+}
+
+static void
+test_snapshot (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraSnapshot snapshot;
+    guint width;
+
+    g_object_get (G_OBJECT (camera), "roi-width", &width, NULL);
+    uca_camera_get_snapshot (camera, &snapshot);
+    g_assert_cmpuint (snapshot.roi_width, ==, width);
+    g_assert_cmpuint (snapshot.format.size, ==, uca_camera_get_frame_size (camera));
+
+    g_object_set (G_OBJECT (camera),
+                  "roi-width", width / 2,
+                  "exposure-time", 0.25,
+                  "trigger-source", UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE,
+                  NULL);
+
+    uca_camera_get_snapshot (camera, &snapshot);
+    g_assert_cmpuint (snapshot.roi_width, ==, width / 2);
+    g_assert_cmpuint (snapshot.format.width, ==, width / 2);
+    g_assert_cmpfloat (snapshot.exposure_time, ==, 0.25);
+    g_assert_cmpint (snapshot.trigger_source, ==, UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE);
+
+    /* Plugin properties that change the layout invalidate the snapshot too */
+    g_object_set (G_OBJECT (camera), "pixel-format", UCA_PIXEL_FORMAT_MONO16, NULL);
+    uca_camera_get_snapshot (camera, &snapshot);
+    g_assert_cmpuint (snapshot.sensor_bitdepth, ==, 16);
+    g_assert_cmpuint (snapshot.format.size, ==, uca_camera_get_frame_size (camera));
+}
+
+static void
+on_batch_notify (GObject *object, GParamSpec *pspec, guint *n_notified)
+{
+    guint width;
+    gdouble exposure_time;
+
+    /* Each notification must already see all values of the batch */
+    g_object_get (object, "roi-width", &width, "exposure-time", &exposure_time, NULL);
+    g_assert_cmpuint (width, ==, 64);
+    g_assert_cmpfloat (exposure_time, ==, 0.5);
+    (*n_notified)++;
+}
+
+static void
+test_batch_properties (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    const gchar *names[] = { "roi-width", "exposure-time", "no-such-property" };
+    GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+    GValue queue_length = G_VALUE_INIT;
+    const gchar *queue_length_name = "dispatch-queue-length";
+    GError *error = NULL;
+    guint n_notified = 0;
+    guint width;
+    guint current;
+
+    g_object_get (G_OBJECT (camera), "roi-width", &width, NULL);
+
+    g_value_init (&values[0], G_TYPE_UINT);
+    g_value_set_uint (&values[0], 64);
+    g_value_init (&values[1], G_TYPE_STRING);
+    g_value_set_string (&values[1], "0.5");
+    g_value_init (&values[2], G_TYPE_INT);
+    g_value_set_int (&values[2], 1);
+
+    /* An unknown property must leave all others untouched */
+    g_assert (!uca_camera_set_properties_batch (camera, 3, names, values, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_IMPLEMENTED);
+    g_clear_error (&error);
+    g_object_get (G_OBJECT (camera), "roi-width", &current, NULL);
+    g_assert_cmpuint (current, ==, width);
+
+    g_signal_connect (camera, "notify::roi-width", G_CALLBACK (on_batch_notify), &n_notified);
+    g_signal_connect (camera, "notify::exposure-time", G_CALLBACK (on_batch_notify), &n_notified);
+
+    g_assert (uca_camera_set_properties_batch (camera, 2, names, values, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (n_notified, ==, 2);
+
+    g_signal_handlers_disconnect_by_data (camera, &n_notified);
+
+    /* Out of range values are rejected instead of being clamped */
+    g_value_init (&queue_length, G_TYPE_UINT);
+    g_value_set_uint (&queue_length, 0);
+    g_assert (!uca_camera_set_properties_batch (camera, 1, &queue_length_name, &queue_length, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_INVALID_VALUE);
+    g_clear_error (&error);
+
+    g_value_unset (&queue_length);
+
+    for (guint i = 0; i < G_N_ELEMENTS (values); i++)
+        g_value_unset (&values[i]);
+}
+
+static guint64
+histogram_total (const UcaCameraHistogram *histogram)
+{
+    guint64 total = 0;
+
+    for (guint i = 0; i < UCA_CAMERA_HISTOGRAM_BINS; i++)
+        total += histogram->bins[i];
+
+    return total;
+}
+
+static void
+test_recording_stats (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraStats stats;
+    GError *error = NULL;
+    guint64 n_grabbed;
+    guint64 n_bytes;
+    gsize size;
+    gpointer buffer;
+
+    size = uca_camera_get_frame_size (camera);
+    buffer = g_malloc0 (size);
+
+    /* Unbuffered grabs account the wait for exclusive camera access */
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 5; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    uca_camera_get_stats (camera, &stats);
+    g_assert_cmpuint (stats.n_grabbed, ==, 5);
+    g_assert_cmpuint (stats.n_bytes, ==, 5 * size);
+    g_assert_cmpuint (stats.n_dropped, ==, 0);
+    g_assert_cmpuint (stats.grab_time.n_samples, ==, 5);
+    g_assert_cmpuint (histogram_total (&stats.grab_time), ==, 5);
+    g_assert_cmpuint (stats.access_wait_time.n_samples, ==, 5);
+    g_assert_cmpuint (stats.consumer_wait_time.n_samples, ==, 0);
+
+    g_object_get (G_OBJECT (camera),
+                  "frames-grabbed", &n_grabbed,
+                  "bytes-transferred", &n_bytes,
+                  NULL);
+    g_assert_cmpuint (n_grabbed, ==, stats.n_grabbed);
+    g_assert_cmpuint (n_bytes, ==, stats.n_bytes);
+
+    /* Restarting resets, buffered recording samples the ring fill level */
+    g_object_set (G_OBJECT (camera), "buffered", TRUE, "num-buffers", 4, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 3; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    uca_camera_get_stats (camera, &stats);
+    g_assert_cmpuint (stats.n_grabbed, >=, 3);
+    g_assert_cmpuint (stats.consumer_wait_time.n_samples, ==, 3);
+    g_assert_cmpuint (stats.fill_level.n_samples, >=, 3);
+    g_assert_cmpuint (stats.fill_level.max, <=, 4);
+    g_assert_cmpuint (stats.access_wait_time.n_samples, ==, 0);
+
+    g_free (buffer);
+}
+
+static gpointer
+cancel_later (GCancellable *cancellable)
+{
+    g_usleep (G_USEC_PER_SEC / 20);
+    g_cancellable_cancel (cancellable);
+    return NULL;
+}
+
+static void
+test_recording_cancel (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraStats stats;
+    GCancellable *cancellable;
+    GThread *thread;
+    GError *error = NULL;
+    gpointer buffer;
+    gint64 start;
+
+    buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+    cancellable = g_cancellable_new ();
+
+    /* Without a trigger the grab would block forever */
+    g_object_set (G_OBJECT (camera),
+                  "trigger-source", UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    thread = g_thread_new (NULL, (GThreadFunc) cancel_later, cancellable);
+    g_assert (!uca_camera_grab_full (camera, buffer, NULL, cancellable, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error (&error);
+    g_thread_join (thread);
+
+    /* A user cancellation does not affect subsequent grabs */
+    uca_camera_trigger (camera, &error);
+    g_assert_no_error (error);
+    g_assert (uca_camera_grab (camera, buffer, &error));
+    g_assert_no_error (error);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Stopping interrupts the buffer thread waiting for a trigger */
+    g_object_set (G_OBJECT (camera), "buffered", TRUE, "exposure-time", 10.0, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_cancellable_reset (cancellable);
+    thread = g_thread_new (NULL, (GThreadFunc) cancel_later, cancellable);
+    g_assert (!uca_camera_grab_full (camera, buffer, NULL, cancellable, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error (&error);
+    g_thread_join (thread);
+
+    start = g_get_monotonic_time ();
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (g_get_monotonic_time () - start, <, G_USEC_PER_SEC);
+
+    uca_camera_get_stats (camera, &stats);
+    g_assert_cmpuint (stats.stop_time, <, G_USEC_PER_SEC);
+
+    g_object_unref (cancellable);
+    g_free (buffer);
+}
+
+typedef struct {
+    UcaCamera *camera;
+    gpointer buffer;
+    guint n_grabbed;
+} FrameSourceData;
+
+static gboolean
+grab_from_source (FrameSourceData *data)
+{
+    GError *error = NULL;
+
+    g_assert (uca_camera_grab (data->camera, data->buffer, &error));
+    g_assert_no_error (error);
+    data->n_grabbed++;
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+test_recording_frame_source (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    FrameSourceData source_data;
+    GMainContext *context;
+    GSource *source;
+    GError *error = NULL;
+    GPollFD poll_fd;
+
+    source_data.camera = camera;
+    source_data.buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+    source_data.n_grabbed = 0;
+
+    context = g_main_context_new ();
+    source = uca_camera_create_frame_source (camera, &error);
+    g_assert_no_error (error);
+    g_assert (source != NULL);
+    g_source_set_callback (source, (GSourceFunc) grab_from_source, &source_data, NULL);
+    g_source_attach (source, context);
+
+    g_object_set (G_OBJECT (camera), "buffered", TRUE, "num-buffers", 4, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    while (source_data.n_grabbed < 5)
+        g_main_context_iteration (context, TRUE);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Without a ring buffer the descriptor must not be readable */
+    poll_fd.fd = uca_camera_get_frame_fd (camera, &error);
+    poll_fd.events = G_IO_IN;
+    poll_fd.revents = 0;
+    g_assert_no_error (error);
+    g_assert_cmpint (g_poll (&poll_fd, 1, 0), ==, 0);
+
+    g_source_destroy (source);
+    g_source_unref (source);
+    g_main_context_unref (context);
+    g_free (source_data.buffer);
+}
+
+typedef struct {
+    guint n_done;
+    guint n_cancelled;
+    guint n_not_recording;
+    guint64 sequence_sum;
+} AsyncData;
+
+static void
+grab_ready (UcaCamera *camera, GAsyncResult *result, AsyncData *data)
+{
+    UcaFrameInfo info;
+    GError *error = NULL;
+
+    if (uca_camera_grab_finish (camera, result, &info, &error)) {
+        data->sequence_sum += info.sequence;
+    }
+    else {
+        g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+        data->n_cancelled++;
+        g_error_free (error);
+    }
+
+    data->n_done++;
+}
+
+static void
+readout_ready (UcaCamera *camera, GAsyncResult *result, AsyncData *data)
+{
+    GError *error = NULL;
+
+    g_assert (!uca_camera_readout_finish (camera, result, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING);
+    g_error_free (error);
+
+    data->n_not_recording++;
+    data->n_done++;
+}
+
+static void
+test_recording_async_grab (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    AsyncData async_data = { 0, };
+    GMainContext *context;
+    GCancellable *cancellable;
+    GError *error = NULL;
+    gpointer buffers[3];
+    gsize size;
+
+    size = uca_camera_get_frame_size (camera);
+    context = g_main_context_new ();
+    g_main_context_push_thread_default (context);
+
+    /* Readouts outside of readout mode fail in the callback */
+    buffers[0] = g_malloc0 (size);
+    uca_camera_readout_async (camera, buffers[0], 0, NULL, (GAsyncReadyCallback) readout_ready, &async_data);
+
+    while (async_data.n_done < 1)
+        g_main_context_iteration (context, TRUE);
+
+    g_assert_cmpuint (async_data.n_not_recording, ==, 1);
+
+    /* Outstanding grabs complete in the caller's context */
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.01, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    async_data.n_done = 0;
+
+    for (guint i = 0; i < 3; i++) {
+        if (i > 0)
+            buffers[i] = g_malloc0 (size);
+
+        uca_camera_grab_async (camera, buffers[i], NULL, (GAsyncReadyCallback) grab_ready, &async_data);
+    }
+
+    while (async_data.n_done < 3)
+        g_main_context_iteration (context, TRUE);
+
+    g_assert_cmpuint (async_data.n_cancelled, ==, 0);
+    g_assert_cmpuint (async_data.sequence_sum, ==, 0 + 1 + 2);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* A grab waiting for a trigger can be cancelled */
+    g_object_set (G_OBJECT (camera),
+                  "trigger-source", UCA_CAMERA_TRIGGER_SOURCE_SOFTWARE,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    cancellable = g_cancellable_new ();
+    async_data.n_done = 0;
+    uca_camera_grab_async (camera, buffers[0], cancellable, (GAsyncReadyCallback) grab_ready, &async_data);
+    g_cancellable_cancel (cancellable);
+
+    while (async_data.n_done < 1)
+        g_main_context_iteration (context, TRUE);
+
+    g_assert_cmpuint (async_data.n_cancelled, ==, 1);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_object_unref (cancellable);
+    g_main_context_pop_thread_default (context);
+    g_main_context_unref (context);
+
+    for (guint i = 0; i < 3; i++)
+        g_free (buffers[i]);
+}
+
+static void
+test_camera_group (Fixture *fixture, gconstpointer data)
+{
+    UcaCameraGroup *group;
+    UcaCameraGroupStats stats;
+    UcaFrame *frames[3];
+    GError *error = NULL;
+    gdouble skew;
+
+    group = uca_camera_group_new ();
+    uca_camera_group_add_camera (group, fixture->camera);
+
+    for (guint i = 1; i < 3; i++) {
+        UcaCamera *camera;
+
+        camera = uca_plugin_manager_get_camera (fixture->manager, "mock", &error, NULL);
+        g_assert_no_error (error);
+        uca_camera_group_add_camera (group, camera);
+        g_object_unref (camera);
+    }
+
+    g_assert_cmpuint (uca_camera_group_get_num_cameras (group), ==, 3);
+    g_assert (uca_camera_group_get_camera (group, 0) == fixture->camera);
+
+    for (guint i = 0; i < 3; i++)
+        g_object_set (uca_camera_group_get_camera (group, i), "exposure-time", 0.01, NULL);
+
+    /* Frames with the same index belong together */
+    g_assert (uca_camera_group_start_recording (group, &error));
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 5; i++) {
+        g_assert (uca_camera_group_grab (group, frames, G_N_ELEMENTS (frames), &skew, &error));
+        g_assert_no_error (error);
+
+        for (guint j = 1; j < 3; j++)
+            g_assert_cmpuint (uca_frame_get_info (frames[j])->sequence, ==, uca_frame_get_info (frames[0])->sequence);
+
+        for (guint j = 0; j < 3; j++)
+            uca_frame_unref (frames[j]);
+    }
+
+    g_assert (uca_camera_group_stop_recording (group, &error));
+    g_assert_no_error (error);
+    g_assert (!uca_camera_is_recording (fixture->camera));
+
+    uca_camera_group_get_stats (group, &stats);
+    g_assert_cmpuint (stats.n_tuples, ==, 5);
+    g_assert (stats.max_skew >= stats.mean_skew);
+
+    /* Frames received within the tolerance belong together */
+    g_object_set (G_OBJECT (group),
+                  "match", UCA_CAMERA_GROUP_MATCH_TIMESTAMP,
+                  "tolerance", 0.02,
+                  NULL);
+
+    g_assert (uca_camera_group_start_recording (group, &error));
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 5; i++) {
+        g_assert (uca_camera_group_grab (group, frames, G_N_ELEMENTS (frames), &skew, &error));
+        g_assert_no_error (error);
+        g_assert_cmpfloat (skew, <=, 0.02);
+
+        for (guint j = 0; j < 3; j++)
+            uca_frame_unref (frames[j]);
+    }
+
+    g_assert (uca_camera_group_stop_recording (group, &error));
+    g_assert_no_error (error);
+
+    g_assert (!uca_camera_group_grab (group, frames, G_N_ELEMENTS (frames), NULL, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING);
+    g_error_free (error);
+
+    g_object_unref (group);
+}
+
+static void
+test_recording_noise (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    guint16 *frame;
+    guint width, height;
+    gdouble sum = 0.0;
+    gdouble sum_squares = 0.0;
+    guint n = 0;
+    gdouble mean, std;
+
+    g_object_set (G_OBJECT (camera),
+                  "pixel-format", UCA_PIXEL_FORMAT_MONO16,
+                  "exposure-time", 0.001,
+                  NULL);
+    g_object_get (G_OBJECT (camera), "roi-width", &width, "roi-height", &height, NULL);
+
+    frame = g_malloc0 (uca_camera_get_frame_size (camera));
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+    g_assert (uca_camera_grab (camera, frame, &error));
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* The central third is Gaussian noise around half the maximum value */
+    for (guint y = height / 3; y < (height * 2) / 3; y++) {
+        for (guint x = width / 3; x < (width * 2) / 3; x++) {
+            gdouble value = GUINT16_FROM_LE (frame[y * width + x]);
+
+            sum += value;
+            sum_squares += value * value;
+            n++;
+        }
+    }
+
+    mean = sum / n;
+    std = sqrt (sum_squares / n - mean * mean);
+    g_assert_cmpfloat (fabs (mean - 32768.0), <, 200.0);
+    g_assert_cmpfloat (fabs (std - 8192.0), <, 200.0);
+
+    g_free (frame);
+}
+
+static void
+test_recording_pacing (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    gpointer buffer;
+    gint64 start, elapsed;
+
+    buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+
+    /* Frames follow a fixed schedule independent of the time between grabs */
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.002, "fill-data", FALSE, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    start = g_get_monotonic_time ();
+
+    for (guint i = 0; i < 50; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    elapsed = g_get_monotonic_time () - start;
+    g_assert_cmpint (elapsed, >=, 50 * 2000);
+    g_assert_cmpint (elapsed, <, G_USEC_PER_SEC);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /*
+     * Work between grabs that is shorter than the period must not add up,
+     * relative sleeps would take 20 * (10 + 5) ms here.
+     */
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.01, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    start = g_get_monotonic_time ();
+
+    for (guint i = 0; i < 20; i++) {
+        g_assert (uca_camera_grab (camera, buffer, &error));
+        g_usleep (5000);
+    }
+
+    elapsed = g_get_monotonic_time () - start;
+    g_assert_cmpint (elapsed, >=, 20 * 10000);
+    g_assert_cmpint (elapsed, <, 20 * 12500);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Without pacing the exposure time is ignored */
+    g_object_set (G_OBJECT (camera), "exposure-time", 1.0, "max-throughput", TRUE, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    start = g_get_monotonic_time ();
+
+    for (guint i = 0; i < 10; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    g_assert_cmpint (g_get_monotonic_time () - start, <, G_USEC_PER_SEC);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+}
+
+static void
+test_recording_pipelined (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraStats stats;
+    UcaFrameInfo info;
+    GError *error = NULL;
+    UcaFrameInfo infos[3];
+    gpointer buffer;
+    gpointer buffers[3];
+    gint64 start, elapsed;
+
+    /* Without fill-data nothing is written, the buffers can be shared */
+    buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+    buffers[0] = buffers[1] = buffers[2] = buffer;
+
+    /* Overlapping exposure and readout halves the serial frame period */
+    g_object_set (G_OBJECT (camera),
+                  "fill-data", FALSE,
+                  "pipelined-readout", TRUE,
+                  "exposure-time", 0.02,
+                  "readout-time", 0.02,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    start = g_get_monotonic_time ();
+
+    for (guint i = 0; i < 20; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    elapsed = g_get_monotonic_time () - start;
+    g_assert_cmpint (elapsed, >=, 19 * 20000);
+    g_assert_cmpint (elapsed, <, 20 * 30000);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* A full sensor queue loses frames which shows as a sequence gap */
+    g_object_set (G_OBJECT (camera),
+                  "exposure-time", 0.005,
+                  "readout-time", 0.005,
+                  "sensor-queue-length", 2,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_usleep (G_USEC_PER_SEC / 5);
+
+    for (guint64 i = 0; i < 2; i++) {
+        g_assert (uca_camera_grab_with_info (camera, buffer, &info, &error));
+        g_assert_cmpuint (info.hw_sequence, ==, i);
+    }
+
+    g_assert (uca_camera_grab_with_info (camera, buffer, &info, &error));
+    g_assert_cmpuint (info.hw_sequence, >, 2);
+
+    uca_camera_get_stats (camera, &stats);
+    g_assert_cmpuint (stats.n_dropped, >, 0);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* A batch does not hide the gap behind its first frame */
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_usleep (G_USEC_PER_SEC / 5);
+
+    g_assert_cmpuint (uca_camera_grab_many (camera, buffers, 3, infos, &error), ==, 3);
+    g_assert_no_error (error);
+    g_assert_cmpuint (infos[0].hw_sequence, ==, 0);
+    g_assert_cmpuint (infos[1].hw_sequence, ==, 1);
+    g_assert_cmpuint (infos[2].hw_sequence, >, 2);
+    g_assert_cmpuint (infos[2].n_dropped, ==, infos[2].hw_sequence - 2);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Without a frame period the sensor waits for room instead of dropping */
+    g_object_set (G_OBJECT (camera), "max-throughput", TRUE, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_usleep (G_USEC_PER_SEC / 20);
+
+    g_assert_cmpuint (uca_camera_grab_many (camera, buffers, 3, infos, &error), ==, 3);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 3; i++)
+        g_assert_cmpuint (infos[i].hw_sequence, ==, i);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+}
+
+static void
+test_recording_trace (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    gchar *filename;
+    gchar *contents;
+    gpointer buffer;
+
+    buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+    filename = g_build_filename (g_get_tmp_dir (), "uca-test-trace.json", NULL);
+
+    uca_trace_clear ();
+    uca_trace_enable (TRUE);
+
+    g_object_set (G_OBJECT (camera), "buffered", TRUE, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 3; i++)
+        g_assert (uca_camera_grab (camera, buffer, &error));
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    uca_trace_enable (FALSE);
+    g_assert (uca_trace_dump (filename, &error));
+    g_assert_no_error (error);
+
+    /* Events of the buffer thread and the consumer end up in one file */
+    g_assert (g_file_get_contents (filename, &contents, NULL, &error));
+    g_assert (g_str_has_prefix (contents, "{\"traceEvents\":["));
+    g_assert (strstr (contents, "\"name\":\"start_recording\"") != NULL);
+    g_assert (strstr (contents, "\"name\":\"grab\"") != NULL);
+    g_assert (strstr (contents, "\"name\":\"uca_camera_grab\"") != NULL);
+    g_assert (strstr (contents, "\"name\":\"ring fill level\"") != NULL);
+    g_assert (strstr (contents, "\"name\":\"thread_name\"") != NULL);
+
+    uca_trace_clear ();
+    g_unlink (filename);
+    g_free (contents);
+    g_free (filename);
+    g_free (buffer);
+}
+
+static void
+test_recording_frame_pool (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    UcaFrame *first;
+    UcaFrame *second;
+    UcaFramePool *pool;
+    GBytes *bytes;
+    gpointer first_data;
+    gsize size;
+
+    g_object_set (G_OBJECT (camera), "num-buffers", 2, NULL);
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    first = uca_camera_grab_frame (camera, &error);
+    g_assert_no_error (error);
+    first_data = uca_frame_get_data (first, &size);
+    g_assert_cmpuint (size, ==, uca_camera_get_frame_size (camera));
+
+    second = uca_camera_grab_frame (camera, &error);
+    g_assert_no_error (error);
+    g_assert (uca_frame_get_data (second, NULL) != first_data);
+    g_assert_cmpuint (uca_frame_get_info (second)->sequence, ==, uca_frame_get_info (first)->sequence + 1);
+
+    /* The bytes keep the frame out of the pool */
+    bytes = uca_frame_get_bytes (first);
+    uca_frame_unref (first);
+    g_assert (g_bytes_get_data (bytes, NULL) == first_data);
+    g_bytes_unref (bytes);
+
+    /* A released frame is handed out again instead of a new allocation */
+    first = uca_camera_grab_frame (camera, &error);
+    g_assert_no_error (error);
+    g_assert (uca_frame_get_data (first, NULL) == first_data);
+
+    uca_frame_unref (first);
+    uca_frame_unref (second);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Frames allocated for a burst are not kept beyond the preallocation */
+    pool = uca_frame_pool_new (64, 1);
+    first = uca_frame_pool_acquire (pool);
+    second = uca_frame_pool_acquire (pool);
+    uca_frame_unref (first);
+    uca_frame_unref (second);
+    g_assert_cmpuint (uca_frame_pool_get_num_idle (pool), ==, 1);
+    uca_frame_pool_unref (pool);
+}
+
 static void
 test_recording_property (Fixture *fixture, gconstpointer data)
 {
@@ -183,6 +1081,424 @@ test_recording_buffered (Fixture *fixture, gconstpointer data)
     g_free (buffer);
 }
 
+static void
+test_recording_buffered_borrow (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    guint width, height, bitdepth;
+    gsize buffer_size;
+    gpointer frame;
+    gchar *copy;
+
+    g_object_get (G_OBJECT (camera),
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  "sensor-bitdepth", &bitdepth,
+                  NULL);
+
+    buffer_size = width * height * (bitdepth <= 8 ? 1 : 2);
+
+    g_object_set (G_OBJECT (camera),
+                  "exposure-time", 0.01,
+                  "buffered", TRUE,
+                  "num-buffers", 2,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    frame = uca_camera_grab_borrow (camera, NULL, &error);
+    g_assert_no_error (error);
+    g_assert (frame != NULL);
+    copy = g_memdup (frame, buffer_size);
+
+    /* The producer would have lapped the two blocks several times by now */
+    g_usleep (G_USEC_PER_SEC / 10);
+    g_assert (memcmp (frame, copy, buffer_size) == 0);
+    uca_camera_frame_release (camera, frame);
+
+    for (int i = 0; i < 5; i++) {
+        frame = uca_camera_grab_borrow (camera, NULL, &error);
+        g_assert_no_error (error);
+        g_assert (frame != NULL);
+        uca_camera_frame_release (camera, frame);
+    }
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (copy);
+}
+
+static void
+test_recording_buffered_timeout (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    guint width, height;
+    gpointer buffer;
+
+    g_object_get (G_OBJECT (camera),
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  NULL);
+
+    buffer = g_malloc0 (width * height * 2);
+
+    g_object_set (G_OBJECT (camera),
+                  "exposure-time", 1.0,
+                  "buffered", TRUE,
+                  "grab-timeout", 0.05,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_assert (!uca_camera_grab (camera, buffer, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_TIMEOUT);
+    g_clear_error (&error);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+}
+
+static void
+test_recording_buffered_unpack (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaFrameFormat format;
+    GError *error = NULL;
+    guint16 *buffer;
+    guint16 max_value = 0;
+
+    g_object_set (G_OBJECT (camera),
+                  "exposure-time", 0.001,
+                  "pixel-format", UCA_PIXEL_FORMAT_MONO12_PACKED,
+                  "buffered", TRUE,
+                  "buffer-unpack", TRUE,
+                  NULL);
+
+    uca_camera_get_frame_format (camera, &format);
+    g_assert_cmpint (format.pixel_format, ==, UCA_PIXEL_FORMAT_MONO16);
+    g_assert_cmpuint (format.bits, ==, 12);
+    g_assert_cmpuint (format.size, ==, format.width * format.height * 2);
+
+    buffer = g_malloc0 (format.size);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (uca_camera_get_frame_size (camera), ==, format.size);
+
+    g_assert (uca_camera_grab (camera, buffer, &error));
+    g_assert_no_error (error);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (gsize i = 0; i < format.width * format.height; i++)
+        max_value = MAX (max_value, buffer[i]);
+
+    g_assert_cmpuint (max_value, >, 0);
+    g_assert_cmpuint (max_value, <, 1 << 12);
+
+    g_free (buffer);
+}
+
+static void
+readout_progress (guint n_done, guint n_total, gpointer user_data)
+{
+    guint *n_progress = user_data;
+
+    g_assert_cmpuint (n_done, ==, *n_progress + 1);
+    g_assert_cmpuint (n_total, ==, 5);
+    *n_progress = n_done;
+}
+
+static void
+test_readout_range (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraReadoutRange *range;
+    GCancellable *cancellable;
+    UcaFrameInfo info;
+    GError *error = NULL;
+    guint n_progress = 0;
+    gpointer buffer;
+
+    range = uca_camera_readout_range (camera, 0, 5, NULL, NULL, NULL, &error);
+    g_assert (range == NULL);
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_NOT_RECORDING);
+    g_clear_error (&error);
+
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.001, NULL);
+    buffer = g_malloc0 (uca_camera_get_frame_size (camera));
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    range = uca_camera_readout_range (camera, 3, 5, NULL, readout_progress, &n_progress, &error);
+    g_assert_no_error (error);
+
+    for (guint i = 0; i < 5; i++) {
+        g_assert (uca_camera_readout_range_grab (range, buffer, &info, &error));
+        g_assert_no_error (error);
+        g_assert_cmpuint (info.sequence, ==, i);
+        g_assert_cmpuint (info.hw_sequence, ==, 3 + i);
+    }
+
+    g_assert (!uca_camera_readout_range_grab (range, buffer, NULL, &error));
+    g_assert_error (error, UCA_CAMERA_ERROR, UCA_CAMERA_ERROR_END_OF_STREAM);
+    g_clear_error (&error);
+    g_assert_cmpuint (n_progress, ==, 5);
+    uca_camera_readout_range_free (range);
+
+    /* Cancelling stops the transfer long before all frames were read */
+    cancellable = g_cancellable_new ();
+    range = uca_camera_readout_range (camera, 0, G_MAXUINT, cancellable, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert (uca_camera_readout_range_grab (range, buffer, NULL, &error));
+
+    g_cancellable_cancel (cancellable);
+    g_assert (!uca_camera_readout_range_grab (range, buffer, NULL, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error (&error);
+
+    uca_camera_readout_range_free (range);
+    g_object_unref (cancellable);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+}
+
+static void
+test_recording_info (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    UcaFrameInfo info;
+    guint width, height;
+    gpointer buffer;
+
+    g_object_get (G_OBJECT (camera),
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  NULL);
+
+    buffer = g_malloc0 (width * height * 2);
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.01, NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (guint64 i = 0; i < 3; i++) {
+        g_assert (uca_camera_grab_with_info (camera, buffer, &info, &error));
+        g_assert_no_error (error);
+        g_assert_cmpuint (info.sequence, ==, i);
+        g_assert_cmpuint (info.hw_sequence, ==, i);
+        g_assert_cmpuint (info.n_dropped, ==, 0);
+        g_assert_cmpint (info.grab_end, >=, info.grab_start);
+    }
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* Let the buffer thread overrun a small ring and check the drop count */
+    g_object_set (G_OBJECT (camera),
+                  "buffered", TRUE,
+                  "num-buffers", 2,
+                  NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_assert (uca_camera_grab_with_info (camera, buffer, &info, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (info.n_dropped, ==, 0);
+
+    g_usleep (G_USEC_PER_SEC / 10);
+
+    g_assert (uca_camera_grab_with_info (camera, buffer, &info, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (info.n_dropped, >, 0);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_free (buffer);
+}
+
+static void
+test_recording_subscribers (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    UcaCameraSubscriber *lossless;
+    UcaCameraSubscriber *latest;
+    GError *error = NULL;
+    UcaFrameInfo info;
+    guint64 last = 0;
+    gpointer frame;
+
+    g_object_set (G_OBJECT (camera),
+                  "exposure-time", 0.01,
+                  "buffered", TRUE,
+                  "num-buffers", 8,
+                  NULL);
+
+    lossless = uca_camera_subscribe (camera, UCA_CAMERA_SUBSCRIBER_LOSSLESS);
+    latest = uca_camera_subscribe (camera, UCA_CAMERA_SUBSCRIBER_LATEST);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (guint64 i = 0; i < 4; i++) {
+        frame = uca_camera_subscriber_borrow (lossless, &info, &error);
+        g_assert_no_error (error);
+        g_assert (frame != NULL);
+        g_assert_cmpuint (info.sequence, ==, i);
+        uca_camera_subscriber_release (lossless, frame);
+
+        frame = uca_camera_subscriber_borrow (latest, &info, &error);
+        g_assert_no_error (error);
+        g_assert (frame != NULL);
+        g_assert (i == 0 || info.sequence > last);
+        last = info.sequence;
+        uca_camera_subscriber_release (latest, frame);
+    }
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    uca_camera_unsubscribe (lossless);
+    uca_camera_unsubscribe (latest);
+}
+
+static void
+test_recording_many (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *camera = UCA_CAMERA (fixture->camera);
+    GError *error = NULL;
+    UcaFrameInfo infos[4];
+    gpointer buffers[4];
+    gpointer stack;
+    gsize size;
+
+    g_object_set (G_OBJECT (camera), "exposure-time", 0.01, NULL);
+    size = uca_camera_get_frame_size (camera);
+    stack = g_malloc0 (4 * size);
+
+    for (int i = 0; i < 4; i++)
+        buffers[i] = g_malloc0 (size);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (uca_camera_grab_many (camera, buffers, 4, infos, &error), ==, 4);
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (uca_camera_grab_stack (camera, stack, 4, NULL, &error), ==, 4);
+    g_assert_no_error (error);
+
+    for (guint64 i = 0; i < 4; i++) {
+        g_assert_cmpuint (infos[i].sequence, ==, i);
+        g_assert_cmpuint (infos[i].n_dropped, ==, 0);
+    }
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    /* The buffered path goes through the ring buffer instead of the vfunc */
+    g_object_set (G_OBJECT (camera), "buffered", TRUE, NULL);
+
+    uca_camera_start_recording (camera, &error);
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (uca_camera_grab_many (camera, buffers, 4, infos, &error), ==, 4);
+    g_assert_no_error (error);
+
+    for (int i = 1; i < 4; i++)
+        g_assert_cmpuint (infos[i].sequence, >, infos[i - 1].sequence);
+
+    uca_camera_stop_recording (camera, &error);
+    g_assert_no_error (error);
+
+    for (int i = 0; i < 4; i++)
+        g_free (buffers[i]);
+
+    g_free (stack);
+}
+
+static gpointer
+grab_frames (UcaCamera *camera)
+{
+    GError *error = NULL;
+    guint width, height;
+    gpointer buffer;
+
+    g_object_get (G_OBJECT (camera),
+                  "roi-width", &width,
+                  "roi-height", &height,
+                  NULL);
+
+    buffer = g_malloc0 (width * height * 2);
+
+    for (int i = 0; i < 10; i++) {
+        uca_camera_grab (camera, buffer, &error);
+        g_assert_no_error (error);
+    }
+
+    g_free (buffer);
+    return NULL;
+}
+
+static void
+test_recording_concurrent (Fixture *fixture, gconstpointer data)
+{
+    UcaCamera *cameras[2];
+    GThread *threads[2];
+    GError *error = NULL;
+    GTimer *timer;
+    gdouble elapsed;
+
+    cameras[0] = fixture->camera;
+    cameras[1] = uca_plugin_manager_get_camera (fixture->manager, "mock", &error, NULL);
+    g_assert_no_error (error);
+
+    for (int i = 0; i < 2; i++) {
+        g_object_set (G_OBJECT (cameras[i]),
+                      "exposure-time", 0.05,
+                      "fill-data", FALSE,
+                      NULL);
+
+        uca_camera_start_recording (cameras[i], &error);
+        g_assert_no_error (error);
+    }
+
+    timer = g_timer_new ();
+
+    for (int i = 0; i < 2; i++)
+        threads[i] = g_thread_new (NULL, (GThreadFunc) grab_frames, cameras[i]);
+
+    for (int i = 0; i < 2; i++)
+        g_thread_join (threads[i]);
+
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    for (int i = 0; i < 2; i++) {
+        uca_camera_stop_recording (cameras[i], &error);
+        g_assert_no_error (error);
+    }
+
+    /* Serialized grabs would take 2 * 10 * 0.05 = 1 s */
+    g_assert_cmpfloat (elapsed, <, 0.75);
+
+    g_timer_destroy (timer);
+    g_object_unref (cameras[1]);
+}
 
 static void
 test_base_properties (Fixture *fixture, gconstpointer data)
@@ -338,8 +1654,30 @@ int main (int argc, char *argv[])
         {"/recording", test_recording},
         {"/recording/signal", test_recording_signal},
         {"/recording/asynchronous", test_recording_async},
+        {"/recording/asynchronous/dispatch", test_recording_async_dispatch},
         {"/recording/buffered", test_recording_buffered},
+        {"/recording/buffered/borrow", test_recording_buffered_borrow},
+        {"/recording/buffered/timeout", test_recording_buffered_timeout},
+        {"/recording/stats", test_recording_stats},
+        {"/recording/cancel", test_recording_cancel},
+        {"/recording/frame-source", test_recording_frame_source},
+        {"/recording/async-grab", test_recording_async_grab},
+        {"/recording/group", test_camera_group},
+        {"/recording/noise", test_recording_noise},
+        {"/recording/pacing", test_recording_pacing},
+        {"/recording/pipelined", test_recording_pipelined},
+        {"/recording/trace", test_recording_trace},
+        {"/recording/frame-pool", test_recording_frame_pool},
+        {"/recording/buffered/unpack", test_recording_buffered_unpack},
+        {"/recording/concurrent", test_recording_concurrent},
+        {"/recording/info", test_recording_info},
+        {"/recording/many", test_recording_many},
+        {"/recording/subscribers", test_recording_subscribers},
+        {"/recording/readout-range", test_readout_range},
+        {"/frame-format", test_frame_format},
         {"/properties/base", test_base_properties},
+        {"/properties/snapshot", test_snapshot},
+        {"/properties/batch", test_batch_properties},
         {"/properties/recording", test_recording_property},
         {"/properties/frames-per-second", test_fps_property},
         {"/properties/units", test_property_units},
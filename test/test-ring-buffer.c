@@ -1,4 +1,6 @@
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
 #include "uca-ring-buffer.h"
 
 
@@ -33,6 +35,79 @@ test_new_func (void)
     g_object_unref (buffer);
 }
 
+static void
+test_new_full (void)
+{
+    UcaRingBuffer *buffer;
+    guint32 *data;
+
+    buffer = uca_ring_buffer_new_full (4096, 4,
+                                       UCA_RING_BUFFER_ALLOC_TRANSPARENT_HUGEPAGES |
+                                       UCA_RING_BUFFER_ALLOC_HUGEPAGES |
+                                       UCA_RING_BUFFER_ALLOC_POPULATE,
+                                       -1);
+
+    g_assert (uca_ring_buffer_get_block_size (buffer) == 4096);
+
+    for (guint32 i = 0; i < 4; i++) {
+        data = uca_ring_buffer_get_write_pointer (buffer);
+        data[0] = i;
+        data[1023] = i;
+        uca_ring_buffer_write_advance (buffer);
+    }
+
+    for (guint32 i = 0; i < 4; i++) {
+        data = uca_ring_buffer_get_read_pointer (buffer);
+        g_assert_cmpuint (data[0], ==, i);
+        g_assert_cmpuint (data[1023], ==, i);
+    }
+
+    g_object_unref (buffer);
+}
+
+static void
+test_new_mapped (void)
+{
+    UcaRingBuffer *buffer;
+    GError *error = NULL;
+    gchar *filename;
+    guint32 *data;
+
+    filename = g_build_filename (g_get_tmp_dir (), "uca-test-ring-buffer.raw", NULL);
+    buffer = uca_ring_buffer_new_mapped (filename, 4096, 8, &error);
+    g_assert_no_error (error);
+    g_assert (buffer != NULL);
+
+    for (guint32 i = 0; i < 8; i++) {
+        data = uca_ring_buffer_get_write_pointer (buffer);
+        data[0] = i;
+        uca_ring_buffer_write_advance (buffer);
+    }
+
+    for (guint32 i = 0; i < 8; i++) {
+        data = uca_ring_buffer_get_read_pointer (buffer);
+        g_assert_cmpuint (data[0], ==, i);
+    }
+
+    g_object_unref (buffer);
+    g_assert (g_file_test (filename, G_FILE_TEST_EXISTS));
+    g_unlink (filename);
+    g_free (filename);
+
+    g_assert (uca_ring_buffer_new_mapped ("/nonexistent/uca.raw", 4096, 8, &error) == NULL);
+    g_assert (error != NULL);
+    g_error_free (error);
+    error = NULL;
+
+    g_assert (g_initable_new (UCA_TYPE_RING_BUFFER, NULL, &error,
+                              "block-size", (guint64) 4096,
+                              "num-blocks", 8,
+                              "backing-file", "/nonexistent/uca.raw",
+                              NULL) == NULL);
+    g_assert (error != NULL);
+    g_error_free (error);
+}
+
 static void
 test_ring (void)
 {
@@ -86,6 +161,169 @@ test_overwrite (void)
     g_assert (data[0] == 0xDEADBEEF);
 }
 
+static void
+test_borrow (void)
+{
+    UcaRingBuffer *buffer;
+    guint32 *data;
+    guint32 *borrowed;
+
+    buffer = uca_ring_buffer_new (512, 1);
+
+    data = uca_ring_buffer_get_write_pointer (buffer);
+    data[0] = 0xBADF00D;
+    uca_ring_buffer_write_advance (buffer);
+
+    borrowed = uca_ring_buffer_borrow_read_pointer (buffer);
+    g_assert (borrowed[0] == 0xBADF00D);
+    g_assert (uca_ring_buffer_is_pinned (buffer, uca_ring_buffer_peek_pointer (buffer)));
+
+    uca_ring_buffer_release_pointer (buffer, borrowed);
+    g_assert (!uca_ring_buffer_is_pinned (buffer, uca_ring_buffer_peek_pointer (buffer)));
+
+    g_object_unref (buffer);
+}
+
+static void
+test_drop_oldest (void)
+{
+    UcaRingBuffer *buffer;
+    guint32 *data;
+
+    buffer = uca_ring_buffer_new (512, 4);
+    g_assert (uca_ring_buffer_get_overrun_policy (buffer) == UCA_RING_BUFFER_OVERRUN_POLICY_DROP_OLDEST);
+
+    for (guint32 i = 0; i < 6; i++) {
+        data = uca_ring_buffer_get_write_pointer (buffer);
+        data[0] = i;
+        uca_ring_buffer_write_advance (buffer);
+    }
+
+    g_assert_cmpuint (uca_ring_buffer_get_num_blocks (buffer), ==, 4);
+    g_assert_cmpuint (uca_ring_buffer_get_num_overruns (buffer), ==, 2);
+    g_assert_cmpuint (uca_ring_buffer_get_fill_level (buffer), ==, 4);
+
+    for (guint32 i = 2; i < 6; i++) {
+        data = uca_ring_buffer_get_read_pointer (buffer);
+        g_assert_cmpuint (data[0], ==, i);
+    }
+
+    g_assert (!uca_ring_buffer_available (buffer));
+    g_assert_cmpuint (uca_ring_buffer_get_fill_level (buffer), ==, 0);
+    g_object_unref (buffer);
+}
+
+static void
+test_drop_newest (void)
+{
+    UcaRingBuffer *buffer;
+    guint32 *data;
+
+    buffer = uca_ring_buffer_new (512, 3);
+    uca_ring_buffer_set_overrun_policy (buffer, UCA_RING_BUFFER_OVERRUN_POLICY_DROP_NEWEST);
+
+    for (guint32 i = 0; i < 5; i++) {
+        data = uca_ring_buffer_get_write_pointer (buffer);
+        g_assert (data != NULL);
+        data[0] = i;
+        uca_ring_buffer_write_advance (buffer);
+    }
+
+    g_assert_cmpuint (uca_ring_buffer_get_num_blocks (buffer), ==, 3);
+    g_assert_cmpuint (uca_ring_buffer_get_num_overruns (buffer), ==, 2);
+
+    for (guint32 i = 0; i < 3; i++) {
+        data = uca_ring_buffer_get_read_pointer (buffer);
+        g_assert_cmpuint (data[0], ==, i);
+    }
+
+    g_object_unref (buffer);
+}
+
+static void
+test_block (void)
+{
+    UcaRingBuffer *buffer;
+    guint32 *data;
+
+    buffer = uca_ring_buffer_new (512, 2);
+    uca_ring_buffer_set_overrun_policy (buffer, UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK);
+
+    for (guint32 i = 0; i < 2; i++) {
+        data = uca_ring_buffer_get_write_pointer (buffer);
+        data[0] = i;
+        uca_ring_buffer_write_advance (buffer);
+    }
+
+    /* Retrying a blocked write counts as a single overrun */
+    g_assert (uca_ring_buffer_get_write_pointer (buffer) == NULL);
+    g_assert (uca_ring_buffer_get_write_pointer (buffer) == NULL);
+    g_assert_cmpuint (uca_ring_buffer_get_num_overruns (buffer), ==, 1);
+
+    data = uca_ring_buffer_get_read_pointer (buffer);
+    g_assert_cmpuint (data[0], ==, 0);
+
+    data = uca_ring_buffer_get_write_pointer (buffer);
+    g_assert (data != NULL);
+    data[0] = 2;
+    uca_ring_buffer_write_advance (buffer);
+
+    data = uca_ring_buffer_get_read_pointer (buffer);
+    g_assert_cmpuint (data[0], ==, 1);
+    data = uca_ring_buffer_get_read_pointer (buffer);
+    g_assert_cmpuint (data[0], ==, 2);
+
+    g_object_unref (buffer);
+}
+
+typedef struct {
+    UcaRingBuffer *buffer;
+    guint32 n_items;
+} SpscData;
+
+static gpointer
+produce (SpscData *spsc)
+{
+    for (guint32 i = 0; i < spsc->n_items; i++) {
+        guint32 *data;
+
+        while ((data = uca_ring_buffer_get_write_pointer (spsc->buffer)) == NULL)
+            g_thread_yield ();
+
+        data[0] = i;
+        uca_ring_buffer_write_advance (spsc->buffer);
+    }
+
+    return NULL;
+}
+
+static void
+test_spsc (void)
+{
+    SpscData spsc;
+    GThread *producer;
+
+    /* Not a power of two to exercise the modulo path */
+    spsc.buffer = uca_ring_buffer_new (64, 3);
+    spsc.n_items = 100000;
+    uca_ring_buffer_set_overrun_policy (spsc.buffer, UCA_RING_BUFFER_OVERRUN_POLICY_BLOCK);
+
+    producer = g_thread_new (NULL, (GThreadFunc) produce, &spsc);
+
+    for (guint32 i = 0; i < spsc.n_items; i++) {
+        guint32 *data;
+
+        while (!uca_ring_buffer_available (spsc.buffer))
+            g_thread_yield ();
+
+        data = uca_ring_buffer_get_read_pointer (spsc.buffer);
+        g_assert_cmpuint (data[0], ==, i);
+    }
+
+    g_thread_join (producer);
+    g_object_unref (spsc.buffer);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -97,8 +335,15 @@ main (int argc, char *argv[])
 
     g_test_add_func ("/ringbuffer/new/constructor", test_new_constructor);
     g_test_add_func ("/ringbuffer/new/func", test_new_func);
+    g_test_add_func ("/ringbuffer/new/full", test_new_full);
+    g_test_add_func ("/ringbuffer/new/mapped", test_new_mapped);
     g_test_add_func ("/ringbuffer/functionality ", test_ring);
     g_test_add_func ("/ringbuffer/overwrite ", test_overwrite);
+    g_test_add_func ("/ringbuffer/borrow", test_borrow);
+    g_test_add_func ("/ringbuffer/overrun/drop-oldest", test_drop_oldest);
+    g_test_add_func ("/ringbuffer/overrun/drop-newest", test_drop_newest);
+    g_test_add_func ("/ringbuffer/overrun/block", test_block);
+    g_test_add_func ("/ringbuffer/spsc", test_spsc);
 
     return g_test_run ();
 }
@@ -0,0 +1,174 @@
+#include <glib.h>
+#include <string.h>
+#include "uca-unpack.h"
+
+
+static guint8 *
+make_packed (gsize n_pixels, guint bits, guint16 **expected)
+{
+    GRand *rand;
+    guint8 *packed;
+    gsize n_bytes;
+
+    rand = g_rand_new_with_seed (bits);
+    n_bytes = (n_pixels * bits + 7) / 8;
+    packed = g_malloc0 (n_bytes);
+    *expected = g_new (guint16, n_pixels);
+
+    /* Set each bit individually to not share any logic with the kernels */
+    for (gsize i = 0; i < n_pixels; i++) {
+        guint16 value = g_rand_int (rand) & ((1 << bits) - 1);
+
+        for (guint k = 0; k < bits; k++) {
+            gsize pos = i * bits + k;
+
+            if (value & (1 << k))
+                packed[pos / 8] |= 1 << (pos % 8);
+        }
+
+        (*expected)[i] = value;
+    }
+
+    g_rand_free (rand);
+    return packed;
+}
+
+static void
+test_kernels (void)
+{
+    static const gsize lengths[] = { 0, 1, 7, 8, 15, 33, 64, 127, 1000 };
+
+    g_assert (uca_unpack_kernel_is_supported (UCA_UNPACK_KERNEL_SCALAR));
+    g_assert (uca_unpack_kernel_is_supported (uca_unpack_get_kernel ()));
+
+    for (guint bits = 1; bits <= 16; bits++) {
+        for (guint i = 0; i < G_N_ELEMENTS (lengths); i++) {
+            gsize n_pixels = lengths[i];
+            guint16 *expected;
+            guint16 *result;
+            guint8 *packed;
+
+            packed = make_packed (n_pixels, bits, &expected);
+            result = g_new (guint16, n_pixels + 1);
+
+            for (UcaUnpackKernel kernel = UCA_UNPACK_KERNEL_SCALAR; kernel <= UCA_UNPACK_KERNEL_AVX512; kernel++) {
+                /* The canary checks that no kernel writes past the end */
+                result[n_pixels] = 0xBEEF;
+
+                if (!uca_unpack_with_kernel (kernel, packed, result, n_pixels, bits))
+                    continue;
+
+                g_assert (memcmp (result, expected, n_pixels * 2) == 0);
+                g_assert_cmpuint (result[n_pixels], ==, 0xBEEF);
+            }
+
+            g_free (result);
+            g_free (expected);
+            g_free (packed);
+        }
+    }
+}
+
+static void
+test_frame (void)
+{
+    UcaFrameFormat format;
+    UcaFrameFormat unpacked;
+    guint16 *expected;
+    guint16 *result;
+    guint8 *packed;
+    guint8 *frame;
+
+    /* Odd width with padding to check that each row starts at its stride */
+    uca_frame_format_init (&format, UCA_PIXEL_FORMAT_MONO12_PACKED, 101, 5, 12, 3);
+    uca_unpack_get_frame_format (&format, &unpacked);
+    g_assert_cmpint (unpacked.pixel_format, ==, UCA_PIXEL_FORMAT_MONO16);
+    g_assert_cmpuint (unpacked.bits, ==, 12);
+    g_assert_cmpuint (unpacked.size, ==, 101 * 5 * 2);
+
+    packed = make_packed (format.width, format.bits, &expected);
+    frame = g_malloc0 (format.size);
+    result = g_malloc (unpacked.size);
+
+    for (guint y = 0; y < format.height; y++)
+        memcpy (frame + y * format.stride, packed, format.stride - format.padding);
+
+    g_assert (uca_unpack_frame (&format, frame, result));
+
+    for (guint y = 0; y < format.height; y++)
+        g_assert (memcmp (result + y * format.width, expected, format.width * 2) == 0);
+
+    uca_frame_format_init (&format, UCA_PIXEL_FORMAT_MONO16, 101, 5, 12, 0);
+    g_assert (!uca_unpack_frame (&format, frame, result));
+
+    g_free (result);
+    g_free (frame);
+    g_free (expected);
+    g_free (packed);
+}
+
+static void
+test_throughput (void)
+{
+    static const UcaPixelFormat formats[] = {
+        UCA_PIXEL_FORMAT_MONO10_PACKED,
+        UCA_PIXEL_FORMAT_MONO12_PACKED,
+        UCA_PIXEL_FORMAT_MONO14_PACKED,
+    };
+    UcaFrameFormat format;
+    guint8 *frame;
+    guint16 *result;
+    GTimer *timer;
+
+    if (!g_test_perf ())
+        return;
+
+    timer = g_timer_new ();
+    result = g_malloc (2048 * 2048 * 2);
+
+    for (guint i = 0; i < G_N_ELEMENTS (formats); i++) {
+        guint bits = uca_pixel_format_get_bits_per_pixel (formats[i]);
+
+        uca_frame_format_init (&format, formats[i], 2048, 2048, bits, 0);
+        frame = g_malloc0 (format.size);
+
+        for (UcaUnpackKernel kernel = UCA_UNPACK_KERNEL_SCALAR; kernel <= UCA_UNPACK_KERNEL_AVX512; kernel++) {
+            const guint n_runs = 50;
+            gdouble elapsed;
+
+            if (!uca_unpack_kernel_is_supported (kernel))
+                continue;
+
+            g_timer_start (timer);
+
+            for (guint run = 0; run < n_runs; run++)
+                uca_unpack_with_kernel (kernel, frame, result, 2048 * 2048, bits);
+
+            elapsed = g_timer_elapsed (timer, NULL);
+            g_test_minimized_result (elapsed / n_runs,
+                                     "%u bit, kernel %i: %.2f GB/s packed input",
+                                     bits, kernel, format.size * n_runs / elapsed / 1e9);
+        }
+
+        g_free (frame);
+    }
+
+    g_free (result);
+    g_timer_destroy (timer);
+}
+
+int
+main (int argc, char *argv[])
+{
+#if !(GLIB_CHECK_VERSION (2, 36, 0))
+    g_type_init ();
+#endif
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/unpack/kernels", test_kernels);
+    g_test_add_func ("/unpack/frame", test_frame);
+    g_test_add_func ("/unpack/throughput", test_throughput);
+
+    return g_test_run ();
+}